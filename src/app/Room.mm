@@ -104,7 +104,7 @@ using namespace nwr::jsrtc;
     easyrtc->set_user_name(ToString(_userName));
     
     easyrtc->set_room_occupant_listener([self](const Optional<std::string> & roomName,
-                                               const std::map<std::string, Any> & occupants,
+                                               const Any::ObjectType & occupants,
                                                const Any & isPrimary)
                                         {
                                             if (*roomName != ToString(_roomName)) {
@@ -129,7 +129,7 @@ using namespace nwr::jsrtc;
                                             for (const std::string & easyrtcid : Keys(occupants)) {
                                                 User * newUser = UserFindByEasyrtcid(_users, nil, ToNSString(easyrtcid));
                                                 if (!newUser) {
-                                                    const Any & userData = occupants.at(easyrtcid);
+                                                    const Any & userData = occupants.at(Atom(easyrtcid));
                                                     newUser = [[User alloc] initWithDelegate:[_delegate userDelegate]
                                                                                    easyrtcId:ToNSString(userData.GetAt("easyrtcid").AsString().value())
                                                                                         name:ToNSString(userData.GetAt("username").AsString().value())
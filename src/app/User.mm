@@ -137,7 +137,7 @@ using namespace nwr::jsrtc;
                       "mute",
                       Any(Any::ObjectType
                           {
-                              { "mute", Any(flag) }
+                              { Atom("mute"), Any(flag) }
                           }),
                       nullptr);
     [self muteWithFlag:flag];
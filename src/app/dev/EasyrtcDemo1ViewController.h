@@ -34,7 +34,7 @@ msgType:(const std::string &)msgType
 content:(const nwr::Any &)content;
 - (void)connect;
 - (void)convertListToButtons:(const nwr::Optional<std::string> &)roomName
-occupants:(const std::map<std::string, nwr::Any> &)occupants
+occupants:(const nwr::Any::ObjectType &)occupants
 isPrimary:(const nwr::Any &)isPrimary;
 - (void)loginSuccess:(const std::string &)easyrtcid;
 - (void)loginFailure:(const std::string &)code
@@ -62,7 +62,7 @@ content:(const nwr::Any &)content
                                   [self addToConversation:user msgType:type content:msg];
                               });
     _easyrtc->set_room_occupant_listener([self](const nwr::Optional<std::string> & roomName,
-                                                const std::map<std::string, nwr::Any> & occupants,
+                                                const nwr::Any::ObjectType & occupants,
                                                 const nwr::Any & isPrimary)
                                          {
                                              [self convertListToButtons:roomName occupants:occupants isPrimary:isPrimary];
@@ -79,7 +79,7 @@ content:(const nwr::Any &)content
 }
 
 - (void)convertListToButtons:(const Optional<std::string> &)roomName
-occupants:(const std::map<std::string, Any> &)occupants
+occupants:(const Any::ObjectType &)occupants
 isPrimary:(const Any &)isPrimary
 {
     for (UIButton * button in _destButtons) {
@@ -89,7 +89,7 @@ isPrimary:(const Any &)isPrimary
     
     occupants_.clear();
     for (const auto & easyrtcid : Keys(occupants)) {
-        auto occupant = occupants.at(easyrtcid);
+        auto occupant = occupants.at(Atom(easyrtcid));
         occupants_.push_back(occupant);        
         
         UIButton * button = [UIButton buttonWithType:UIButtonTypeSystem];
@@ -57,7 +57,7 @@ using namespace nwr;
                                   [self addToConversation:who msgType:msg_type content:content];
                               });
     _easyrtc->set_room_occupant_listener([self](const Optional<std::string> & room_name,
-                                                 const std::map<std::string, Any> & occupant_list,
+                                                 const Any::ObjectType & occupant_list,
                                                  const Any & is_primary)
                                          {
                                              [self convertListToButtons:room_name
@@ -98,7 +98,7 @@ using namespace nwr;
 }
 
 - (void)convertListToButtons:(const Optional<std::string> &)roomName
-                   occupants:(const std::map<std::string, Any> &)occupants
+                   occupants:(const Any::ObjectType &)occupants
                    isPrimary:(const Any &)isPrimary
 {
     for (UIView * view in _destViews) {
@@ -108,7 +108,7 @@ using namespace nwr;
     
     occupants_.clear();
     for (const auto & easyrtcid : Keys(occupants)) {
-        auto occupant = occupants.at(easyrtcid);
+        auto occupant = occupants.at(Atom(easyrtcid));
         occupants_.push_back(occupant);
         
         printf("%s\n", occupant.ToJsonString().c_str());
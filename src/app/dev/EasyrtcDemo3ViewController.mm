@@ -63,7 +63,7 @@ public:
 - (void)connect {
     _easyrtc->set_video_dims(640, 480, None());
     _easyrtc->set_room_occupant_listener([self](const Optional<std::string> & room_name,
-                                                const std::map<std::string, Any> & occupant_list,
+                                                const Any::ObjectType & occupant_list,
                                                 const Any & is_primary)
                                          {
                                              [self convertListToButtons:room_name
@@ -84,7 +84,7 @@ public:
 }
 
 - (void)convertListToButtons:(const Optional<std::string> &)roomName
-                   occupants:(const std::map<std::string, Any> &)occupants
+                   occupants:(const Any::ObjectType &)occupants
                    isPrimary:(const Any &)isPrimary
 {
     for (UIView * view in _destViews) {
@@ -94,7 +94,7 @@ public:
     
     _occupants.clear();
     for (const auto & easyrtcid : Keys(occupants)) {
-        auto occupant = occupants.at(easyrtcid);
+        auto occupant = occupants.at(Atom(easyrtcid));
         _occupants.push_back(occupant);
         
         printf("%s\n", occupant.ToJsonString().c_str());
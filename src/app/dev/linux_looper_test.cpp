@@ -0,0 +1,139 @@
+//
+//  linux_looper_test.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+//  smoke test of LinuxLooper, built by CMakeLists.txt on Linux.
+//  prints in the format of NwrTestSet and exits with 1 on a failure.
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <nwr/base/linux_looper.h>
+#include <nwr/base/timer.h>
+
+namespace {
+    using namespace nwr;
+
+    int test_index = 0;
+    int failure_count = 0;
+#define ASSERT(x) assert_body(x, #x)
+
+    void assert_body(bool x, const char * s) {
+        if(x) {
+            printf("ok %d - %s\n", test_index, s);
+        } else {
+            printf("not ok %d - %s\n", test_index, s);
+            failure_count += 1;
+        }
+        test_index += 1;
+    }
+
+    //  posts from several threads all run on the loop thread
+    void TestPostTask() {
+        const int thread_count = 4;
+        const int count = 10000;
+        auto looper = std::static_pointer_cast<LinuxLooper>(Looper::Create());
+
+        std::atomic<int> run_count(0);
+        std::atomic<bool> wrong_queue(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&]{
+                for (int i = 0; i < count; i++) {
+                    looper->PostTask([&]{
+                        if (TaskQueue::current_queue() != looper) {
+                            wrong_queue = true;
+                        }
+                        run_count += 1;
+                    });
+                }
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        //  runs the tasks posted before, then joins
+        looper->Quit();
+
+        ASSERT(run_count == thread_count * count);
+        ASSERT(!wrong_queue);
+    }
+
+    //  delayed tasks run in the order of their deadlines, not of their posts
+    void TestPostDelayedTask() {
+        auto looper = std::make_shared<LinuxLooper>();
+        std::vector<int> order;
+        const auto start = LinuxLooper::Clock::now();
+
+        looper->PostDelayedTask(TimeDuration(0.03), [&]{ order.push_back(30); });
+        looper->PostDelayedTask(TimeDuration(0.01), [&]{ order.push_back(10); });
+        looper->PostDelayedTask(TimeDuration(0.02), [&]{ order.push_back(20); });
+        looper->PostDelayedTask(TimeDuration(0.04), [&]{ looper->Quit(); });
+        looper->Run();
+
+        ASSERT((order == std::vector<int> { 10, 20, 30 }));
+        ASSERT(LinuxLooper::Clock::now() - start >= std::chrono::milliseconds(40));
+    }
+
+    //  a deadline scheduled from another thread before the armed one rearms the timerfd
+    void TestEarlierDeadline() {
+        auto looper = std::make_shared<LinuxLooper>();
+        const auto start = LinuxLooper::Clock::now();
+        LinuxLooper::Clock::time_point ran_at;
+
+        looper->PostDelayedTask(TimeDuration(0.5), [&]{ looper->Quit(); });
+        std::thread thread([&]{
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            looper->PostDelayedTask(TimeDuration(0.01), [&]{ ran_at = LinuxLooper::Clock::now(); });
+        });
+        looper->Run();
+        thread.join();
+
+        ASSERT(ran_at - start < std::chrono::milliseconds(200));
+    }
+
+    //  a repeating Timer and Sleep on the TimerService of the looper
+    void TestTimer() {
+        auto looper = std::make_shared<LinuxLooper>();
+        int tick_count = 0;
+        bool slept = false;
+        TimerPtr timer;
+
+        looper->PostTask([&]{
+            timer = Timer::Create(TimeDuration(0.01), TimeDuration(0.01), [&]{
+                tick_count += 1;
+                if (tick_count == 3) {
+                    timer->Cancel();
+                    Sleep(TimeDuration(0.01))->Then([&](const None &) {
+                        slept = true;
+                        looper->Quit();
+                        return None();
+                    });
+                }
+            });
+        });
+        looper->Run();
+
+        ASSERT(tick_count == 3);
+        ASSERT(slept);
+        //  run by the loop, not by the thread of the shared service
+        ASSERT(looper->timer_service() != TimerService::shared());
+        ASSERT(looper->timer_service()->pending_count() == 0);
+    }
+}
+
+int main() {
+    TestPostTask();
+    TestPostDelayedTask();
+    TestEarlierDeadline();
+    TestTimer();
+    printf("1..%d\n", test_index);
+    return failure_count == 0 ? 0 : 1;
+}
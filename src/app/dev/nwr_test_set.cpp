@@ -8,6 +8,36 @@
 
 #include "nwr_test_set.h"
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#include <openssl/ssl.h>
+#include <nwr/base/base64.h>
+#include <nwr/base/websocket.h>
+#include <nwr/base/websocket_impl.h>
+#include <nwr/base/json.h>
+#include <nwr/base/map.h>
+#include <nwr/base/any_arena.h>
+#include <nwr/base/timer.h>
+#include <nwr/base/promise.h>
+#include <nwr/base/task_instrument.h>
+#include <nwr/base/virtual_time_queue.h>
+#include <nwr/base/worker_pool.h>
+#include <nwr/engineio/parser.h>
+#include <nwr/socketio/parser.h>
+#include <nwr/socketio0/parser.h>
+#include <nwr/socketio0/transport.h>
+
 namespace app {
     using namespace nwr;
     
@@ -23,11 +53,20 @@ namespace app {
         test_index += 1;
     }
     
+    //  runs body loop times and returns the wall time of all of them in microseconds
+    double Measure(int loop, const std::function<void()> & body) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < loop; i++) {
+            body();
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    
     void NwrTestSet::TestAnyType() {
-        Any a(std::map<std::string, Any> {
-            { "a", Any(3) },
-            { "b", Any("bbb") },
-            { "c", Any(std::vector<Any> {
+        Any a(Any::ObjectType {
+            { Atom("a"), Any(3) },
+            { Atom("b"), Any("bbb") },
+            { Atom("c"), Any(std::vector<Any> {
                 Any(11),
                 Any(22),
                 Any(33)
@@ -51,15 +90,415 @@ namespace app {
         c = Any(3);
         ASSERT(c.AsInt() == Some(3));
         ASSERT(b.GetAt("b").AsString() == Some(std::string("bbb")));
-        
+
         Any d = Any(Any::ObjectType {
-            { "aa", Any(Any::ObjectType {
-                { "bb", Any(1) }
+            { Atom("aa"), Any(Any::ObjectType {
+                { Atom("bb"), Any(1) }
             }) }
         });
         ASSERT(d.GetAt("aa").GetAt("bb").AsInt() == Some(1));
         d.GetAt("aa").SetAt("bb", Any(2));
         ASSERT(d.GetAt("aa").GetAt("bb").AsInt() == Some(2));
+
+        //  borrowed views share the container
+        ASSERT(a.GetAt("c").AsArrayPointer()->size() == 3);
+        ASSERT(&(*a.GetAt("c").AsArrayPointer())[0] == &(*b.GetAt("c").AsArrayPointer())[0]);
+        ASSERT(a.AsArrayPointer() == nullptr);
+        ASSERT(a.GetAt("c").AsObjectPointer() == nullptr);
+        std::vector<std::string> visited;
+        a.ForEach([&](const std::string & key, const Any & value) {
+            visited.push_back(key);
+        });
+        ASSERT(visited == a.keys());
+
+        //  symbol and owned keys
+        ASSERT(Atom("msgType").is_symbol());
+        ASSERT(Atom(std::string("msgType")) == atoms::kMsgType);
+        ASSERT(!Atom("Xk2bM9mFuA0tIfGp").is_symbol());
+        ASSERT(Atom("Xk2bM9mFuA0tIfGp") == Atom(std::string("Xk2bM9mFuA0tIfGp")));
+        Any h(Any::ObjectType {
+            { Atom("zzz"), Any(1) },
+            { atoms::kMsgType, Any("offer") },
+            { Atom("Xk2bM9mFuA0tIfGp"), Any(2) }
+        });
+        ASSERT(h.GetAt(atoms::kMsgType).AsString() == Some(std::string("offer")));
+        ASSERT(h.GetAt("msgType").AsString() == Some(std::string("offer")));
+        ASSERT(h.GetAt(std::string("Xk2bM9mFuA0tIfGp")).AsInt() == Some(2));
+        ASSERT(h.HasKey("zzz"));
+        ASSERT(!h.HasKey(atoms::kMsgData));
+        ASSERT((h.keys() == std::vector<std::string> { "Xk2bM9mFuA0tIfGp", "msgType", "zzz" }));
+        ASSERT(Atom("zzz") != Atom("zz"));
+        ASSERT(Atom("msgTyp") != atoms::kMsgType);
+        ASSERT(Atom("msgTyp") < atoms::kMsgType && !(atoms::kMsgType < atoms::kMsgType));
+        ASSERT(!h.HasKey("Qw7rT1yUiO3pAsDf"));
+        ASSERT(h.GetAt(std::string("Qw7rT1yUiO3pAsDf")).type() == Any::Type::Null);
+        h.RemoveAt("Qw7rT1yUiO3pAsDf");
+        h.RemoveAt("zzz");
+        ASSERT(!h.HasKey("zzz"));
+        
+        //  inline and heap strings keep value semantics
+        std::string long_str(Any::kInlineStringCapacity + 10, 'x');
+        Any e = Any(long_str);
+        Any f = e;
+        ASSERT(f == e);
+        f = Any("short");
+        ASSERT(e.AsString() == Some(long_str));
+        ASSERT(f.AsString() == Some(std::string("short")));
+        Any g = std::move(e);
+        ASSERT(g.AsString() == Some(long_str));
+        ASSERT(e.type() == Any::Type::Null);
+    }
+    
+    //  easyrtc payloads recorded from test-server/easyrtc, sio0 event body
+    std::vector<std::string> EasyrtcSamplePayloads() {
+        return {
+            R"({"name":"easyrtcCmd","args":[{"msgType":"roomData","msgData":{"roomData":{"default":{"roomName":"default","roomStatus":"join","clientList":{"Xk2bM9mFuA0tIfGp":{"easyrtcid":"Xk2bM9mFuA0tIfGp","roomJoinTime":1458123456789,"presence":{"show":"chat","status":""},"apiField":{"mediaIds":{"fieldName":"mediaIds","fieldValue":{"default":"b7a1c2e4-9d3f-4e21-8a55-0c1d2e3f4a5b"}}}},"p0QwErTyUiOpAsDf":{"easyrtcid":"p0QwErTyUiOpAsDf","roomJoinTime":1458123460012,"presence":{"show":"away","status":"brb"}},"ZxCvBnMaSdFgHjKl":{"easyrtcid":"ZxCvBnMaSdFgHjKl","roomJoinTime":1458123470345,"presence":{"show":"chat","status":""}}}}}},"serverTime":1458123471000}]})",
+            R"({"name":"easyrtcMsg","args":[{"senderEasyrtcid":"Xk2bM9mFuA0tIfGp","targetEasyrtcid":"p0QwErTyUiOpAsDf","msgType":"candidate","msgData":{"type":"candidate","label":0,"id":"audio","candidate":"candidate:842163049 1 udp 1677729535 203.0.113.7 61733 typ srflx raddr 192.168.1.5 rport 61733 generation 0"},"serverTime":1458123472123}]})",
+            R"({"name":"easyrtcMsg","args":[{"senderEasyrtcid":"Xk2bM9mFuA0tIfGp","targetEasyrtcid":"p0QwErTyUiOpAsDf","msgType":"offer","msgData":{"type":"offer","sdp":"v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE audio\r\na=msid-semantic: WMS b7a1c2e4\r\nm=audio 9 UDP/TLS/RTP/SAVPF 111 103 104 9 0 8 106 105 13 126\r\nc=IN IP4 0.0.0.0\r\na=rtcp:9 IN IP4 0.0.0.0\r\na=ice-ufrag:Wl3M\r\na=ice-pwd:q2wR8p7K1fGxY0cVbN3mZ5aS\r\na=fingerprint:sha-256 5B:2F:0E:44:1A:9C:7D:33:81:AF:02:6E:B4:C9:11:58:9D:E2:37:0A:6C:F1:84:29:5E:BB:13:70:C6:48:2D:9F\r\na=setup:actpass\r\na=mid:audio\r\na=sendrecv\r\na=rtcp-mux\r\na=rtpmap:111 opus/48000/2\r\na=fmtp:111 minptime=10;useinbandfec=1\r\na=ssrc:3735928559 cname:k9Jd8sHq2LmN4pQr\r\n"},"serverTime":1458123472456}]})",
+            R"({"name":"easyrtcCmd","args":[{"msgType":"ack","msgData":{},"serverTime":1458123472789}]})"
+        };
+    }
+    
+    void NwrTestSet::BenchJsonParse() {
+        const int loop = 2000;
+        auto payloads = EasyrtcSamplePayloads();
+        
+        auto measure = [&](const char * name, const std::function<void(const std::string &)> & parse) {
+            const double us = Measure(loop, [&]{
+                for (const auto & payload : payloads) {
+                    parse(payload);
+                }
+            });
+            printf("[BenchJsonParse] %s: %.0f us / %d packets\n",
+                   name, us, loop * (int)payloads.size());
+        };
+        
+        measure("Json::Reader + Any::FromJson", [](const std::string & payload) {
+            auto json = JsonParse(payload);
+            Any::FromJson(*json);
+        });
+        measure("JsonParseAny", [](const std::string & payload) {
+            Any any;
+            JsonParseAny(AsDataPointer(payload), static_cast<int>(payload.size()), any);
+        });
+        
+        for (const auto & payload : payloads) {
+            Any any;
+            JsonParseAny(AsDataPointer(payload), static_cast<int>(payload.size()), any);
+            ASSERT(any.ToJsonString() == Any::FromJson(*JsonParse(payload)).ToJsonString());
+        }
+        
+        Any any;
+        JsonParseError error;
+        std::string broken = R"({"msgType":"ack",})";
+        ASSERT(!JsonParseAny(AsDataPointer(broken), static_cast<int>(broken.size()), any, &error));
+        ASSERT(error.position == 17);
+    }
+    
+    void NwrTestSet::BenchJsonFormat() {
+        const int loop = 2000;
+        std::vector<Any> values;
+        for (const auto & payload : EasyrtcSamplePayloads()) {
+            values.push_back(Any::FromJsonString(payload));
+        }
+        
+        auto measure = [&](const char * name, const std::function<void(const Any &)> & format) {
+            const double us = Measure(loop, [&]{
+                for (const auto & value : values) {
+                    format(value);
+                }
+            });
+            printf("[BenchJsonFormat] %s: %.0f us / %d packets\n",
+                   name, us, loop * (int)values.size());
+        };
+        
+        measure("Any::ToJson + JsonFormat", [](const Any & value) {
+            JsonFormat(*value.ToJson());
+        });
+        std::string buffer;
+        measure("JsonAppendAny", [&buffer](const Any & value) {
+            buffer.clear();
+            JsonAppendAny(buffer, value);
+        });
+        
+        for (const auto & value : values) {
+            auto json = JsonParse(value.ToJsonString());
+            ASSERT(json != nullptr);
+            ASSERT(Any::FromJson(*json).ToJsonString() == value.ToJsonString());
+        }
+        
+        ASSERT(Any(3).ToJsonString() == "3");
+        ASSERT(Any(-0.0).ToJsonString() == "0");
+        ASSERT(Any(0.1).ToJsonString() == "0.1");
+        ASSERT(Any(1.0 / 3.0).ToJsonString() == "0.3333333333333333");
+        ASSERT(Any(1e300).ToJsonString() == "1e+300");
+        ASSERT(Any("a\"b\\\n\x01").ToJsonString() == "\"a\\\"b\\\\\\n\\u0001\"");
+        
+        std::string packet = "42";
+        JsonAppendAny(packet, Any(Any::ArrayType { Any("hello"), Any(1.5) }));
+        ASSERT(packet == "42[\"hello\",1.5]");
+    }
+    
+    void NwrTestSet::BenchObjectMap() {
+        const int loop = 100000;
+        std::vector<std::string> keys = {
+            "msgType", "msgData", "senderEasyrtcid", "targetEasyrtcid",
+            "easyrtcid", "serverTime", "roomName", "msgId"
+        };
+        
+        auto measure = [&](const char * name, const std::function<void()> & body) {
+            printf("[BenchObjectMap] %s: %.0f us / %d loops\n",
+                   name, Measure(loop, body), loop);
+        };
+        
+        std::map<std::string, Any> tree_map;
+        Any::ObjectType flat_map;
+        for (const auto & key : keys) {
+            tree_map[key] = Any(key);
+            flat_map[Atom(key)] = Any(key);
+        }
+        Any object(flat_map);
+        
+        int found = 0;
+        measure("std::map GetAt", [&]() {
+            for (const auto & key : keys) {
+                auto iter = tree_map.find(key);
+                if (iter != tree_map.end()) { found += 1; }
+            }
+        });
+        measure("FlatMap GetAt", [&]() {
+            for (const auto & key : keys) {
+                if (object.GetAt(key)) { found += 1; }
+            }
+        });
+        measure("std::map SetAt", [&]() {
+            std::map<std::string, Any> map;
+            for (const auto & key : keys) {
+                map[key] = Any(found);
+            }
+        });
+        measure("FlatMap SetAt", [&]() {
+            Any map(Any::ObjectType{});
+            for (const auto & key : keys) {
+                map.SetAt(key, Any(found));
+            }
+        });
+        measure("std::map keys", [&]() {
+            found += static_cast<int>(Keys(tree_map).size());
+        });
+        measure("FlatMap keys", [&]() {
+            found += static_cast<int>(object.keys().size());
+        });
+        
+        ASSERT(found > 0);
+        ASSERT(object.keys() == Keys(tree_map));
+        ASSERT(JsonFormatAny(object) == JsonFormatAny(Any(Any::ObjectType(tree_map.begin(), tree_map.end()))));
+        
+        Any::ObjectType map {
+            { Atom("b"), Any(2) },
+            { Atom("a"), Any(1) },
+            { Atom("b"), Any(3) }
+        };
+        ASSERT(map.size() == 2);
+        ASSERT(map.begin()->first == "a");
+        ASSERT(map.at(Atom("b")).AsInt() == Some(2));
+        ASSERT(map.erase(Atom("a")) == 1);
+        ASSERT(map.erase(Atom("a")) == 0);
+        ASSERT(!HasKey(map, Atom("a")));
+    }
+    
+    void NwrTestSet::BenchAnyArena() {
+        const int loop = 2000;
+        std::vector<std::string> sio_packets;
+        std::vector<std::string> sio0_packets;
+        for (const auto & payload : EasyrtcSamplePayloads()) {
+            Any event = Any::FromJsonString(payload);
+            sio_packets.push_back(std::string("2") + JsonFormatAny(Any(Any::ArrayType {
+                event.GetAt("name"), event.GetAt("args").GetAt(0)
+            })));
+            sio0_packets.push_back(std::string("5:::") + payload);
+        }
+        
+        //  the decoded packets are held until the end of each run,
+        //  so the blocks in use after it are the heap allocations the packets keep.
+        //  the body counters tell how many Any bodies went to the heap or an arena
+        SetAnyAllocationCountEnabled(true);
+        auto measure = [&](const char * name, const std::function<void(std::vector<Any> &)> & decode) {
+            std::vector<Any> kept;
+            kept.reserve(loop * sio_packets.size());
+            ResetAnyAllocationStats();
+            malloc_statistics_t before, after;
+            malloc_zone_statistics(nullptr, &before);
+            const double us = Measure(loop, [&]{ decode(kept); });
+            malloc_zone_statistics(nullptr, &after);
+            auto stats = GetAnyAllocationStats();
+            printf("[BenchAnyArena] %s: %.0f us, %.1f blocks %.0f bytes / packet, bodies heap %lld arena %lld / %d loops\n",
+                   name, us,
+                   double(after.blocks_in_use - before.blocks_in_use) / kept.size(),
+                   double(after.size_in_use - before.size_in_use) / kept.size(),
+                   (long long)stats.heap_count, (long long)stats.arena_count, loop);
+        };
+        
+        //  through the Decoder, as the Manager does
+        auto decode_sio = [&](bool to_arena) {
+            auto decoder = std::make_shared<sio::Decoder>(false, to_arena);
+            auto out = std::make_shared<std::vector<Any> *>(nullptr);
+            decoder->decoded_emitter()->On([out](const sio::Packet & packet) {
+                (*out)->push_back(packet.data);
+            });
+            return [&, decoder, out](std::vector<Any> & kept) {
+                *out = &kept;
+                for (const auto & packet : sio_packets) {
+                    decoder->Add(eio::PacketData(packet));
+                }
+            };
+        };
+        //  as the Transport does
+        auto decode_sio0 = [&](bool to_arena) {
+            return [&, to_arena](std::vector<Any> & kept) {
+                for (const auto & packet : sio0_packets) {
+                    AnyArena::Scope scope(to_arena ? std::make_shared<AnyArena>() : nullptr);
+                    kept.push_back(Any(sio0::DecodePacket(packet).args));
+                }
+            };
+        };
+        measure("sio heap", decode_sio(false));
+        measure("sio arena", decode_sio(true));
+        measure("sio0 heap", decode_sio0(false));
+        measure("sio0 arena", decode_sio0(true));
+        
+        //  values outlive their scope and arena
+        Any kept;
+        {
+            AnyArena::Scope scope(std::make_shared<AnyArena>());
+            kept = sio::DecodeString(sio_packets[0]).data;
+        }
+        ASSERT(kept.GetAt(1).GetAt(atoms::kMsgType).AsString() == Some(std::string("roomData")));
+        
+        ResetAnyAllocationStats();
+        Any promoted = PromoteFromArena(kept);
+        ASSERT(GetAnyAllocationStats().arena_count == 0);
+        ASSERT(promoted.ToJsonString() == kept.ToJsonString());
+        ASSERT(promoted.GetAt(1) != kept.GetAt(1));
+        
+        {
+            AnyArena::Scope scope(std::make_shared<AnyArena>());
+            ResetAnyAllocationStats();
+            PromoteFromArena(kept);
+            ASSERT(GetAnyAllocationStats().arena_count == 0);
+        }
+        ASSERT(AnyArena::current() == nullptr);
+        
+        //  the Decoder uses an arena only when asked to
+        ResetAnyAllocationStats();
+        std::vector<Any> decoded;
+        decode_sio(false)(decoded);
+        ASSERT(GetAnyAllocationStats().arena_count == 0);
+        decode_sio(true)(decoded);
+        ASSERT(GetAnyAllocationStats().arena_count > 0);
+        
+        SetAnyAllocationCountEnabled(false);
+        ResetAnyAllocationStats();
+        sio::DecodeString(sio_packets[0]);
+        ASSERT(GetAnyAllocationStats().heap_count == 0);
+    }
+    
+    void NwrTestSet::TestBufferSlice() {
+        auto backing = std::make_shared<Data>(ToData("42[\"roomData\",{\"msgType\":\"roomData\"}]"));
+        BufferSlice whole(backing);
+        ASSERT(whole.size() == static_cast<int>(backing->size()));
+        ASSERT(whole.ToDataPtr() == backing);
+        
+        BufferSlice tail = whole.Slice(1);
+        ASSERT(tail.backing() == backing);
+        ASSERT(tail.ptr() == backing->data() + 1);
+        ASSERT(ToString(tail.Slice(0, 1)) == "2");
+        ASSERT(tail.ToDataPtr() != backing);
+        ASSERT(ToString(*tail.ToDataPtr()) == ToString(tail));
+        
+        //  a received text frame reaches socket.io without a copy
+        eio::Packet text = eio::DecodePacket(Websocket::Message(Websocket::Message::Mode::Text, backing));
+        ASSERT(text.type == eio::PacketType::Message);
+        ASSERT(!text.data.binary);
+        ASSERT(text.data.slice.backing() == backing);
+        ASSERT(text.data.ptr() == backing->data() + 1);
+        ASSERT(sio::DecodeString(text.data.char_ptr(), text.data.size()).data.GetAt(0).AsString() ==
+               Some(std::string("roomData")));
+        
+        auto binary_backing = std::make_shared<Data>(Data { 4, 1, 2, 3 });
+        eio::Packet binary = eio::DecodePacket(Websocket::Message(Websocket::Message::Mode::Binary, binary_backing));
+        ASSERT(binary.data.binary);
+        ASSERT(binary.data.slice.backing() == binary_backing);
+        ASSERT(binary.data.size() == 3);
+        
+        eio::Packet base64 = eio::DecodePacket(Websocket::Message("b4AQID"));
+        ASSERT(base64.data.binary);
+        ASSERT(DataFormat(base64.data.ptr(), base64.data.size()) == "01 02 03");
+    }
+    
+    //  the former OpenSSL BIO implementation, as the reference of BenchBase64
+    void BioBase64Encode(const Data & data, Data & dest_str) {
+        BIO * bio = BIO_new(BIO_s_mem());
+        BIO * base64 = BIO_new(BIO_f_base64());
+        bio = BIO_push(base64, bio);
+        BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
+        BIO_write(bio, &data[0], (int)data.size());
+        BIO_flush(bio);
+        BUF_MEM * buf_mem;
+        BIO_get_mem_ptr(bio, &buf_mem);
+        dest_str.assign(buf_mem->data, buf_mem->data + buf_mem->length);
+        BIO_free_all(bio);
+    }
+    void BioBase64Decode(const Data & str, Data & dest_data) {
+        dest_data.resize(Base64CalcDecodedSize(str));
+        BIO * bio = BIO_new_mem_buf(const_cast<uint8_t *>(&str[0]), (int)str.size());
+        BIO * base64 = BIO_new(BIO_f_base64());
+        bio = BIO_push(base64, bio);
+        BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
+        BIO_read(bio, &dest_data[0], (int)str.size());
+        BIO_free_all(bio);
+    }
+    
+    void NwrTestSet::BenchBase64() {
+        const int loop = 200;
+        std::mt19937 random(1);
+        
+        for (int size : { 0, 1, 2, 3, 47, 48, 49, 1000 }) {
+            Data data(size);
+            for (auto & byte : data) { byte = static_cast<uint8_t>(random()); }
+            Data encoded, bio_encoded, decoded;
+            Base64Encode(data, encoded);
+            BioBase64Encode(data, bio_encoded);
+            ASSERT(encoded == bio_encoded);
+            ASSERT(Base64Decode(encoded, decoded) && decoded == data);
+        }
+        Data decoded;
+        ASSERT(Base64Decode(ToData("AQID"), decoded) && DataFormat(decoded) == "01 02 03");
+        ASSERT(Base64Decode(ToData("AQ"), decoded) && DataFormat(decoded) == "01");
+        ASSERT(!Base64Decode(ToData("AQI*"), decoded));
+        ASSERT(!Base64Decode(ToData("AQIDA"), decoded));
+        //  a slice of a received frame
+        auto frame = std::make_shared<Data>(ToData("b\x01\x02\x03"));
+        Data slice_encoded;
+        Base64Encode(BufferSlice(frame).Slice(1), slice_encoded);
+        ASSERT(slice_encoded == ToData("AQID"));
+        
+        //  a 64KB binary frame as engine.io sends it to a polling client
+        Data data(64 * 1024);
+        for (auto & byte : data) { byte = static_cast<uint8_t>(random()); }
+        Data encoded;
+        Base64Encode(data, encoded);
+        
+        auto measure = [&](const char * name, int bytes, const std::function<void()> & body) {
+            const double us = Measure(loop, body);
+            printf("[BenchBase64] %s: %.0f us, %.1f MB/s\n",
+                   name, us, (double)bytes * loop / std::max(us, 1.0));
+        };
+        Data dest;
+        measure("encode BIO", (int)data.size(), [&]{ BioBase64Encode(data, dest); });
+        measure("encode", (int)data.size(), [&]{ Base64Encode(data, dest); });
+        measure("decode BIO", (int)encoded.size(), [&]{ BioBase64Decode(encoded, dest); });
+        measure("decode", (int)encoded.size(), [&]{ Base64Decode(encoded, dest); });
     }
     
     void NwrTestSet::TestEio() {
@@ -82,6 +521,989 @@ namespace app {
             });
         });
     }
+    int CountThreads() {
+        thread_act_array_t threads;
+        mach_msg_type_number_t count = 0;
+        if (task_threads(mach_task_self(), &threads, &count) != KERN_SUCCESS) {
+            return -1;
+        }
+        for (mach_msg_type_number_t i = 0; i < count; i++) {
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(threads), sizeof(thread_t) * count);
+        return static_cast<int>(count);
+    }
+    
+    //  against test-server/eio
+    void NwrTestSet::TestWebsocketThreads() {
+        const int count = 200;
+        const std::string url = "ws://192.168.1.5:8080/engine.io/?EIO=3&transport=websocket";
+        
+        //  held for the whole test, so its service thread is counted before the sockets.
+        //  an empty task through PostTaskSync waits for the Attach and Detach posted before it
+        auto context = WebsocketContext::Shared(nullptr, false);
+        context->thread()->PostTaskSync([]{});
+        const int threads = CountThreads();
+        
+        auto sockets = std::make_shared<std::vector<std::shared_ptr<Websocket>>>();
+        auto finished = std::make_shared<int>(0);
+        
+        auto finish = [sockets, finished, context, threads, count](const char * event) {
+            *finished += 1;
+            if (*finished < count) { return; }
+            printf("[TestWebsocketThreads] %d sockets finished, last event: %s\n", count, event);
+            ASSERT(CountThreads() == threads);
+            for (const auto & socket : *sockets) {
+                socket->Close();
+            }
+            sockets->clear();
+            context->thread()->PostTaskSync([]{});
+            ASSERT(CountThreads() == threads);
+        };
+        
+        for (int i = 0; i < count; i++) {
+            auto socket = Websocket::Create(url, "");
+            socket->set_on_open([finish]{ finish("open"); });
+            socket->set_on_error([finish](const std::string & error){ finish("error"); });
+            sockets->push_back(socket);
+        }
+        context->thread()->PostTaskSync([]{});
+        printf("[TestWebsocketThreads] threads: %d before, %d after %d sockets\n",
+               threads, CountThreads(), count);
+        ASSERT(CountThreads() == threads);
+    }
+    
+    //  against test-server/eio on the same host, which echoes binary messages
+    void NwrTestSet::BenchWebsocketSend() {
+        const int count = 2000;
+        const int size = 16 * 1024;
+        
+        auto socket = Websocket::Create("ws://127.0.0.1:8080/engine.io/?EIO=3&transport=websocket", "");
+        auto received = std::make_shared<int>(0);
+        auto start = std::make_shared<std::chrono::steady_clock::time_point>();
+        
+        socket->set_on_open([socket, start, count, size]{
+            Data payload(size, 0x5a);
+            eio::Packet packet { eio::PacketType::Message, eio::PacketData(payload) };
+            
+            auto message = eio::EncodePacket(packet);
+            ASSERT(message.has_send_padding());
+            ASSERT(message.data.size() == 1 + size);
+            
+            *start = std::chrono::steady_clock::now();
+            for (int i = 0; i < count; i++) {
+                socket->Send(eio::EncodePacket(packet));
+            }
+        });
+        socket->set_on_message([socket, received, start, count, size](const Websocket::Message & message){
+            if (message.mode != Websocket::Message::Mode::Binary) { return; }
+            *received += 1;
+            if (*received < count) { return; }
+            
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>
+            (std::chrono::steady_clock::now() - *start);
+            printf("[BenchWebsocketSend] %d x %d bytes echoed: %lld us, %.1f MB/s\n",
+                   count, size, (long long)elapsed.count(),
+                   (double)count * size / std::max((long long)elapsed.count(), 1LL));
+            socket->Close();
+        });
+        socket->set_on_error([](const std::string & error){
+            printf("[BenchWebsocketSend] error: %s\n", error.c_str());
+        });
+    }
+    
+    //  against test-server/ws-deflate on the same host, which echoes with permessage-deflate
+    void NwrTestSet::TestWebsocketDeflate() {
+        Websocket::Options options;
+        options.per_message_deflate = true;
+        auto socket = Websocket::Create("ws://127.0.0.1:8081/", "", nullptr, options);
+        
+        std::string payload;
+        for (int i = 0; i < 200; i++) {
+            payload += Format("{\"id\":%d,\"type\":\"candidate\",\"label\":\"audio\"},", i);
+        }
+        
+        socket->set_on_open([socket, payload]{
+            socket->Send(payload);
+        });
+        socket->set_on_message([socket, payload](const Websocket::Message & message){
+            ASSERT(ToString(message.data) == payload);
+            
+            auto stats = socket->stats();
+            printf("[TestWebsocketDeflate] sent %lld bytes, %lld on wire (%.3f); "
+                   "received %lld bytes, %lld on wire (%.3f)\n",
+                   (long long)stats.sent_bytes, (long long)stats.sent_wire_bytes,
+                   stats.send_compression_ratio(),
+                   (long long)stats.received_bytes, (long long)stats.received_wire_bytes,
+                   stats.receive_compression_ratio());
+            ASSERT(stats.sent_bytes == (int64_t)payload.size());
+            ASSERT(stats.sent_wire_bytes < stats.sent_bytes);
+            ASSERT(stats.received_bytes == (int64_t)payload.size());
+            ASSERT(stats.received_wire_bytes < stats.received_bytes);
+            socket->Close();
+        });
+        socket->set_on_error([](const std::string & error){
+            printf("[TestWebsocketDeflate] error: %s\n", error.c_str());
+        });
+    }
+    
+    //  against test-server/eio on the same host
+    void NwrTestSet::TestWebsocketBackpressure() {
+        const int count = 64;
+        const int size = 16 * 1024;
+        
+        Websocket::Options options;
+        options.buffered_amount_high_watermark = 64 * 1024;
+        options.buffered_amount_low_watermark = 16 * 1024;
+        auto socket = Websocket::Create("ws://127.0.0.1:8080/engine.io/?EIO=3&transport=websocket",
+                                        "", nullptr, options);
+        auto high_count = std::make_shared<int>(0);
+        
+        socket->set_on_buffered_amount_high([socket, high_count, options](int64_t amount){
+            *high_count += 1;
+            ASSERT(amount >= options.buffered_amount_high_watermark);
+        });
+        socket->set_on_buffered_amount_low([socket, high_count, options](int64_t amount){
+            printf("[TestWebsocketBackpressure] high %d time(s), low at %lld bytes\n",
+                   *high_count, (long long)amount);
+            ASSERT(*high_count == 1);
+            ASSERT(amount <= options.buffered_amount_low_watermark);
+            ASSERT(socket->buffered_amount() <= options.buffered_amount_low_watermark);
+            socket->Close();
+        });
+        socket->set_on_open([socket, high_count, count, size]{
+            Data payload(size, 0x5a);
+            eio::Packet packet { eio::PacketType::Message, eio::PacketData(payload) };
+            for (int i = 0; i < count; i++) {
+                socket->Send(eio::EncodePacket(packet));
+            }
+            //  posted, so not inside Send; reported once however far past the watermark
+            ASSERT(*high_count == 0);
+        });
+        socket->set_on_error([](const std::string & error){
+            printf("[TestWebsocketBackpressure] error: %s\n", error.c_str());
+        });
+    }
+    
+    //  against test-server/ws-deflate on the same host, which echoes;
+    //  lws delivers a large frame in fragments of its rx buffer size
+    void NwrTestSet::TestWebsocketReassembly() {
+        const int size = 1024 * 1024;
+        
+        Data payload(size);
+        for (int i = 0; i < size; i++) {
+            payload[i] = static_cast<uint8_t>(i * 31);
+        }
+        
+        auto socket = Websocket::Create("ws://127.0.0.1:8081/", "");
+        auto received = std::make_shared<int>(0);
+        socket->set_on_open([socket, payload]{
+            socket->Send(payload);
+            socket->Send(payload);
+        });
+        socket->set_on_message([socket, payload, received](const Websocket::Message & message){
+            ASSERT(message.mode == Websocket::Message::Mode::Binary);
+            ASSERT(message.data.size() == static_cast<int>(payload.size()));
+            ASSERT(std::equal(payload.begin(), payload.end(), message.data.ptr()));
+            *received += 1;
+            if (*received == 2) {
+                printf("[TestWebsocketReassembly] %d bytes x 2 ok\n", (int)payload.size());
+                socket->Close();
+            }
+        });
+        
+        Websocket::Options options;
+        options.max_message_size = 1024;
+        auto limited = Websocket::Create("ws://127.0.0.1:8081/", "", nullptr, options);
+        auto error = std::make_shared<std::string>();
+        limited->set_on_open([limited]{
+            limited->Send(Data(4096, 0x5a));
+        });
+        limited->set_on_message([](const Websocket::Message & message){
+            ASSERT(false);
+        });
+        limited->set_on_error([error](const std::string & message){
+            *error = message;
+        });
+        limited->set_on_close([limited, error]{
+            printf("[TestWebsocketReassembly] limited: %s\n", error->c_str());
+            ASSERT(IndexOf(*error, "message too large") != -1);
+        });
+    }
+    
+    //  against test-server/ws-deflate on the same host, which echoes
+    void NwrTestSet::TestWebsocketStats() {
+        const int count = 10;
+        
+        auto socket = Websocket::Create("ws://127.0.0.1:8081/", "");
+        auto received = std::make_shared<int>(0);
+        socket->set_on_open([socket, count]{
+            for (int i = 0; i < count; i++) {
+                socket->Send(Format("message %d", i));
+            }
+        });
+        socket->set_on_message([socket, received, count](const Websocket::Message & message){
+            *received += 1;
+            if (*received < count) { return; }
+            
+            auto stats = socket->stats();
+            ASSERT(stats.connections == 1);
+            ASSERT(stats.sent_messages == count);
+            ASSERT(stats.received_messages == count);
+            ASSERT(stats.received_fragments >= count);
+            ASSERT(stats.max_received_message_size == (int64_t)std::string("message 0").size());
+            ASSERT(stats.send_queue_depth == 0);
+            ASSERT(1 <= stats.send_queue_peak && stats.send_queue_peak <= count);
+            ASSERT(stats.max_send_latency <= stats.total_send_latency);
+            ASSERT(stats.connect_duration.count() > 0);
+            ASSERT(stats.handshake_duration.count() > 0);
+            
+            socket->Close();
+            stats = socket->stats();
+            ASSERT(stats.close_reason == "closed locally");
+            printf("[TestWebsocketStats]\n%s", ToString(stats).c_str());
+            
+            auto sum = stats;
+            sum += stats;
+            ASSERT(sum.connections == 2);
+            ASSERT(sum.sent_messages == 2 * count);
+            ASSERT(sum.send_queue_peak == stats.send_queue_peak);
+            ASSERT(sum.close_reason == stats.close_reason);
+        });
+        socket->set_on_error([](const std::string & error){
+            printf("[TestWebsocketStats] error: %s\n", error.c_str());
+        });
+    }
+    
+    void NwrTestSet::TestTimerService() {
+        const int count = 10000;
+        using Clock = std::chrono::steady_clock;
+        
+        struct State {
+            int fired;
+            int ended;
+            int64_t total_late_us;
+            int64_t max_late_us;
+            int threads_before;
+        };
+        auto state = std::make_shared<State>(State { 0, 0, 0, 0, CountThreads() });
+        auto timers = std::make_shared<std::vector<TimerPtr>>();
+        
+        auto on_end = [state, timers, count]{
+            state->ended += 1;
+            if (state->ended < count) { return; }
+            
+            printf("[TestTimerService] %d timers, %d fired, late average %lld us, max %lld us, "
+                   "threads %d -> %d\n",
+                   count, state->fired,
+                   (long long)(state->total_late_us / std::max(state->fired, 1)),
+                   (long long)state->max_late_us,
+                   state->threads_before, CountThreads());
+            ASSERT(state->fired == count - count / 4);
+            ASSERT(TimerService::shared()->pending_count() == 0);
+            timers->clear();
+        };
+        
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> delay_ms(0, 2000);
+        for (int i = 0; i < count; i++) {
+            const auto delay = std::chrono::milliseconds(delay_ms(random));
+            const auto deadline = Clock::now() + delay;
+            auto timer = Timer::Create(delay, [state, deadline]{
+                const int64_t late_us = std::chrono::duration_cast<std::chrono::microseconds>
+                (Clock::now() - deadline).count();
+                ASSERT(late_us >= 0);
+                state->fired += 1;
+                state->total_late_us += late_us;
+                state->max_late_us = std::max(state->max_late_us, late_us);
+            });
+            timer->end_emitter()->On([on_end](None none){ on_end(); });
+            timers->push_back(timer);
+        }
+        
+        //  one service thread however many timers
+        ASSERT(CountThreads() <= state->threads_before + 1);
+        
+        //  cancelled timers end without waiting for their deadline
+        for (int i = 0; i < count; i += 4) {
+            (*timers)[i]->Cancel();
+        }
+    }
+    
+    //  the former WebsocketThread, as the reference of BenchWebsocketThreadLatency
+    class LegacyWebsocketThread {
+    public:
+        explicit LegacyWebsocketThread(lws_context * context):
+        context_(context),
+        do_quit_(false)
+        {
+            thread_ = std::thread([this]{
+                while (!do_quit_) {
+                    lws_service(context_, 1000);
+                    while (true) {
+                        Task task;
+                        {
+                            std::lock_guard<std::mutex> lk(mutex_);
+                            if (tasks_.size() == 0) { break; }
+                            task = std::move(tasks_.front());
+                            tasks_.pop_front();
+                        }
+                        task();
+                    }
+                }
+            });
+        }
+        void PostTask(Task && task) {
+            {
+                std::lock_guard<std::mutex> lk(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            lws_cancel_service(context_);
+        }
+        void Quit() {
+            PostTask([this]{ do_quit_ = true; });
+            thread_.join();
+        }
+    private:
+        lws_context * context_;
+        std::thread thread_;
+        std::mutex mutex_;
+        std::deque<Task> tasks_;
+        bool do_quit_;
+    };
+    
+    void NwrTestSet::TestPromise() {
+        struct State {
+            std::vector<int> steps;
+            std::string error;
+            bool stopped_ran;
+        };
+        auto state = std::make_shared<State>(State { {}, "", false });
+        auto queue = TaskQueue::current_queue();
+        
+        Sleep(TimeDuration(0.05))
+        ->Then([state, queue](None none) {
+            ASSERT(TaskQueue::current_queue() == queue);
+            state->steps.push_back(1);
+            
+            //  settled on another thread, resumed on this queue
+            auto promise = Promise<int>::Create();
+            std::thread([promise]{
+                promise->Resolve(41);
+            }).detach();
+            return promise;
+        })
+        ->Then([state, queue](const int & value) {
+            ASSERT(TaskQueue::current_queue() == queue);
+            state->steps.push_back(2);
+            return value + 1;
+        })
+        ->Then([state](const int & value) {
+            ASSERT(value == 42);
+            state->steps.push_back(3);
+            return Promise<std::string>::Rejected("rejected");
+        })
+        ->Then([state](const std::string & value) {
+            state->steps.push_back(4);
+        })
+        ->Catch([state](const std::string & error) {
+            state->error = error;
+        });
+        
+        Promise<int>::Resolved(1)
+        ->Then([](const int & value) {
+            return PromisePtr<int>();
+        })
+        ->Then([state](const int & value) {
+            state->stopped_ran = true;
+        });
+        
+        Sleep(TimeDuration(0.5))
+        ->Then([state](None none) {
+            ASSERT((state->steps == std::vector<int> { 1, 2, 3 }));
+            ASSERT(state->error == "rejected");
+            ASSERT(!state->stopped_ran);
+        });
+    }
+    
+    void NwrTestSet::TestWorkerStage() {
+        const int count = 10000;
+        struct State {
+            std::vector<int> delivered;
+            bool on_queue;
+        };
+        auto state = std::make_shared<State>(State { {}, true });
+        auto queue = TaskQueue::current_queue();
+        
+        auto stage = WorkerStage<int>::Create([state, queue, count](const int & value) {
+            state->on_queue = state->on_queue && TaskQueue::current_queue() == queue;
+            state->delivered.push_back(value);
+            if (state->delivered.size() < count) { return; }
+            
+            bool ordered = true;
+            for (int i = 0; i < count; i++) {
+                ordered = ordered && state->delivered[i] == i;
+            }
+            ASSERT(ordered);
+            ASSERT(state->on_queue);
+        });
+        
+        //  uneven work, so the workers finish out of order
+        for (int i = 0; i < count; i++) {
+            stage->Run([i]{
+                volatile int sum = 0;
+                for (int k = 0; k < (i * 7919) % 5000; k++) {
+                    sum += k;
+                }
+                return i;
+            });
+        }
+        ASSERT(WorkerPool::shared()->thread_num() >= 1);
+    }
+    
+    void NwrTestSet::TestTaskInstrument() {
+        //  every value within 1/16 of its bucket
+        for (int64_t value : { 0, 15, 16, 17, 31, 32, 1000, 123456, 987654321 }) {
+            const int index = LatencyHistogram::BucketIndex(value);
+            const int64_t lowest = LatencyHistogram::BucketLowest(index);
+            ASSERT(lowest <= value && value < LatencyHistogram::BucketLowest(index + 1));
+            ASSERT(value - lowest <= value / 16);
+        }
+        LatencyHistogram histogram;
+        for (int i = 1; i <= 1000; i++) {
+            histogram.Record(i);
+        }
+        ASSERT(histogram.count() == 1000);
+        ASSERT(histogram.min() == 1 && histogram.max() == 1000);
+        ASSERT(std::abs(histogram.ValueAtRatio(0.5) - 500) <= 500 / 16);
+        ASSERT(std::abs(histogram.ValueAtRatio(0.99) - 990) <= 990 / 16);
+        
+        auto & instrument = TaskInstrument::shared();
+        instrument.Reset();
+        
+        const int count = 20;
+        std::mutex mutex;
+        std::condition_variable done_cond;
+        int done = 0;
+        //  called on the pool threads, so checked here after the join
+        std::vector<TaskInstrument::SlowTask> slow_tasks;
+        instrument.set_slow_task_callback(TimeDuration(0.004), [&](const TaskInstrument::SlowTask & task) {
+            std::lock_guard<std::mutex> lk(mutex);
+            slow_tasks.push_back(task);
+        });
+        instrument.set_enabled(true);
+        {
+            auto pool = std::make_shared<WorkerPool>(2);
+            for (int i = 0; i < count; i++) {
+                //  one of four is slow
+                const auto sleep = std::chrono::milliseconds(i % 4 == 0 ? 5 : 1);
+                pool->PostTask(Task(NWR_HERE, [&, sleep]{
+                    std::this_thread::sleep_for(sleep);
+                    std::lock_guard<std::mutex> lk(mutex);
+                    done += 1;
+                    done_cond.notify_one();
+                }));
+            }
+            pool->PostTask([]{});
+            
+            std::unique_lock<std::mutex> lk(mutex);
+            done_cond.wait(lk, [&]{ return done == count; });
+        }
+        instrument.set_enabled(false);
+        instrument.set_slow_task_callback(TimeDuration(0), nullptr);
+        
+        //  the pool joined, so all the records are in
+        auto stats = instrument.Snapshot();
+        int64_t tagged = 0;
+        int64_t untagged = 0;
+        for (const auto & site : stats) {
+            ASSERT(site.queue == "WorkerPool");
+            if (site.location.size() > 0) {
+                ASSERT(site.location.find("nwr_test_set.cpp:") != std::string::npos);
+                ASSERT(site.run_time.min() >= 1000);
+                tagged += site.run_time.count();
+            } else {
+                untagged += site.run_time.count();
+            }
+        }
+        ASSERT(tagged == count);
+        ASSERT(untagged == 1);
+        ASSERT(slow_tasks.size() == count / 4);
+        for (const auto & task : slow_tasks) {
+            ASSERT(std::string(task.queue) == "WorkerPool");
+            ASSERT(task.run_time >= TimeDuration(0.004));
+        }
+        printf("[TestTaskInstrument]\n%s\n", ToString(stats).c_str());
+        
+        instrument.Reset();
+        ASSERT(instrument.Snapshot().size() == 0);
+        
+        //  copies of the same literals at other addresses are the same site
+        static const char queue_copy[] = "WorkerPool";
+        static const char location_a[] = "nwr_test_set.cpp:1";
+        static const char location_b[] = "nwr_test_set.cpp:1";
+        instrument.set_enabled(true);
+        instrument.Wrap("WorkerPool", Task(location_a, []{}))();
+        instrument.Wrap(queue_copy, Task(location_b, []{}))();
+        instrument.set_enabled(false);
+        stats = instrument.Snapshot();
+        ASSERT(stats.size() == 1);
+        ASSERT(stats[0].run_time.count() == 2);
+        instrument.Reset();
+    }
+    
+    void NwrTestSet::TestVirtualTimeQueue() {
+        //  a heartbeat timer and a reconnection backoff over an hour, twice
+        auto simulate = []{
+            auto queue = std::make_shared<VirtualTimeQueue>();
+            struct State {
+                std::vector<std::string> log;
+                TimerPtr heartbeat;
+                std::function<void(int)> reconnect;
+            };
+            auto state = std::make_shared<State>();
+            auto log = [state, queue](const std::string & event) {
+                state->log.push_back(Format("%.3f %s", queue->elapsed().count(), event.c_str()));
+            };
+            
+            queue->PostTask([state, log]{
+                state->heartbeat = Timer::Create(TimeDuration(25), TimeDuration(25), [log]{
+                    log("ping");
+                });
+                state->reconnect = [state, log](int attempt) {
+                    log(Format("reconnect %d", attempt));
+                    if (attempt == 10) { return; }
+                    const double delay = std::min(64.0, std::pow(2.0, attempt));
+                    Sleep(TimeDuration(delay))->Then([state, attempt](None _) {
+                        state->reconnect(attempt + 1);
+                    });
+                };
+                state->reconnect(0);
+            });
+            queue->RunFor(TimeDuration(3600));
+            ASSERT(queue->elapsed() == TimeDuration(3600));
+            
+            queue->PostTask([state]{
+                state->heartbeat->Cancel();
+                state->heartbeat = nullptr;
+                state->reconnect = nullptr;
+            });
+            queue->RunUntilIdle();
+            ASSERT(queue->timer_service()->pending_count() == 0);
+            ASSERT(queue->elapsed() == TimeDuration(3600));
+            return state->log;
+        };
+        
+        auto log = simulate();
+        ASSERT(log == simulate());
+        ASSERT(std::count_if(log.begin(), log.end(), [](const std::string & line) {
+            return line.find("ping") != std::string::npos;
+        }) == 3600 / 25);
+        //  0, then 1 + 2 + 4 + 8 + 16 + 32 + 64 * 4 = 319 seconds later
+        ASSERT(std::find(log.begin(), log.end(), "319.000 reconnect 10") != log.end());
+        
+        //  a cancelled task is destroyed after the unlock,
+        //  so a capture may cancel another timer from its destructor
+        TimerService service { TimerService::Clock::time_point() };
+        auto other = service.Schedule(service.now() + std::chrono::seconds(2), []{});
+        std::shared_ptr<void> guard(nullptr, [&service, other](void *) { service.Cancel(other); });
+        auto entry = service.Schedule(service.now() + std::chrono::seconds(1), [guard]{});
+        guard = nullptr;
+        ASSERT(service.Cancel(entry));
+        ASSERT(service.pending_count() == 0);
+    }
+    
+    //  an engine.io server on the other end, answering the pings after a second while it is alive
+    class ScriptedEioTransport: public eio::Transport {
+    public:
+        ScriptedEioTransport(const ConstructorParams & params):
+        Transport(params),
+        answers_ping(true)
+        {}
+        
+        std::string name() override { return "scripted"; }
+        void Receive(const eio::Packet & packet) { OnPacket(packet); }
+        
+        bool answers_ping;
+        std::vector<TimeDuration> ping_times;
+    protected:
+        void DoOpen() override { OnOpen(); }
+        void DoClose() override {}
+        void Write(const std::vector<eio::Packet> & packets) override {
+            writable_ = false;
+            for (const auto & packet : packets) {
+                if (packet.type != eio::PacketType::Ping) { continue; }
+                ping_times.push_back(VirtualTimeQueue::current()->elapsed());
+                if (answers_ping) {
+                    Sleep(TimeDuration(1))->Then([this](None) {
+                        Receive(eio::Packet { eio::PacketType::Pong, eio::PacketData("") });
+                    });
+                }
+            }
+            flush_emitter_->Emit(None());
+            TaskQueue::current_queue()->PostTask([this]{
+                writable_ = true;
+                drain_emitter_->Emit(None());
+            });
+        }
+    };
+    
+    void NwrTestSet::TestEioHeartbeat() {
+        auto queue = std::make_shared<VirtualTimeQueue>();
+        std::shared_ptr<eio::Socket> socket;
+        std::shared_ptr<ScriptedEioTransport> transport;
+        Optional<TimeDuration> closed_at;
+        
+        queue->PostTask([&]{
+            eio::Socket::ConstructorParams params;
+            params.transport_factory = [&](const std::string & name, const eio::Transport::ConstructorParams & p) {
+                transport = std::make_shared<ScriptedEioTransport>(p);
+                return transport;
+            };
+            socket = eio::Socket::Create("ws://example.com", params);
+            socket->close_emitter()->On([&](None) {
+                closed_at = Some(queue->elapsed());
+            });
+            transport->Receive(eio::Packet {
+                eio::PacketType::Open,
+                eio::PacketData("{\"sid\":\"abc\",\"pingInterval\":25000,\"pingTimeout\":5000}")
+            });
+        });
+        queue->RunFor(TimeDuration(600));
+        
+        //  a ping 25 seconds after each pong, a second after its ping
+        ASSERT(!closed_at);
+        ASSERT(transport->ping_times.size() == 23);
+        for (size_t i = 0; i < transport->ping_times.size(); i++) {
+            ASSERT(transport->ping_times[i] == TimeDuration(25 + 26 * i));
+        }
+        
+        //  the ping unanswered closes the socket after the ping timeout
+        transport->answers_ping = false;
+        queue->RunUntilIdle();
+        ASSERT(closed_at == Some(transport->ping_times.back() + TimeDuration(5)));
+        ASSERT(queue->timer_service()->pending_count() == 0);
+    }
+    
+    //  a socket.io 0.9 server on the other end, sending a heartbeat every 25 seconds while it is alive
+    class ScriptedSio0Transport: public sio0::Transport {
+    public:
+        ScriptedSio0Transport(const std::shared_ptr<sio0::CoreSocket> & socket, const std::string & sessid):
+        Transport(socket, sessid)
+        {}
+        
+        std::string name() override { return "scripted"; }
+        //  opens on the next task, as a websocket does, and the server connects
+        void Open() override {
+            auto thiz = std::static_pointer_cast<ScriptedSio0Transport>(shared_from_this());
+            TaskQueue::current_queue()->PostTask([thiz]{
+                thiz->OnOpen();
+                thiz->socket()->SetBuffer(false);
+                thiz->OnData("1::");
+            });
+        }
+        void Send(const std::string & data) override {
+            sent.push_back(data);
+        }
+        void SendPayload(const std::vector<sio0::Packet> & payload) override {
+            for (const auto & packet : payload) {
+                SendPacket(packet);
+            }
+        }
+        void Close() override {}
+        std::string scheme() override { return "ws"; }
+        
+        std::vector<std::string> sent;
+    };
+    
+    void NwrTestSet::TestSio0CloseTimeout() {
+        auto queue = std::make_shared<VirtualTimeQueue>();
+        std::shared_ptr<sio0::CoreSocket> socket;
+        std::shared_ptr<ScriptedSio0Transport> transport;
+        TimerPtr server_heartbeat;
+        Optional<TimeDuration> disconnected_at;
+        
+        queue->PostTask([&]{
+            sio0::SocketOptions options;
+            options.host = Some(std::string("example.com"));
+            options.query = Some(std::string());
+            //  a longer heartbeat timeout, so the close timeout of 60 seconds is what disconnects
+            options.fetch = [](const HttpRequest & request) {
+                HttpResponse response;
+                response.code = 200;
+                response.data = std::make_shared<Data>(ToData("abc:120:60:websocket"));
+                return Promise<HttpResponse>::Resolved(response);
+            };
+            options.transport_factory = [&](const std::shared_ptr<sio0::CoreSocket> & s, const std::string & sessid) {
+                transport = std::make_shared<ScriptedSio0Transport>(s, sessid);
+                return transport;
+            };
+            socket = sio0::CoreSocket::Create(options);
+            socket->emitter()->On("disconnect", AnyEventListenerMake([&](const Any & reason) {
+                disconnected_at = Some(queue->elapsed());
+            }));
+            server_heartbeat = Timer::Create(TimeDuration(25), TimeDuration(25), [&]{
+                transport->OnData("2::");
+            });
+        });
+        queue->RunFor(TimeDuration(600));
+        
+        //  every heartbeat of the server is answered and keeps the connection
+        ASSERT(socket->connected());
+        ASSERT(!disconnected_at);
+        ASSERT(std::count(transport->sent.begin(), transport->sent.end(), "2::") == 600 / 25);
+        
+        //  the silence of the server for the close timeout disconnects
+        queue->PostTask([&]{
+            server_heartbeat->Cancel();
+        });
+        queue->RunUntilIdle();
+        ASSERT(disconnected_at == Some(TimeDuration(600 + 60)));
+        ASSERT(!socket->connected());
+        ASSERT(queue->timer_service()->pending_count() == 0);
+    }
+    
+    void NwrTestSet::BenchVirtualTime() {
+        //  many clients with a heartbeat and a reconnection storm,
+        //  as the CPU time per simulated minute
+        const int clients = 1000;
+        const double minutes = 60;
+        
+        auto queue = std::make_shared<VirtualTimeQueue>();
+        struct State {
+            std::vector<TimerPtr> heartbeats;
+            std::function<void(int, int)> reconnect;
+            int64_t pings;
+            int64_t reconnects;
+        };
+        auto state = std::make_shared<State>();
+        state->pings = 0;
+        state->reconnects = 0;
+        
+        queue->PostTask([state, clients]{
+            for (int i = 0; i < clients; i++) {
+                //  spread, so the heartbeats do not all fire at once
+                state->heartbeats.push_back(Timer::Create(TimeDuration(25.0 * i / clients),
+                                                          TimeDuration(25),
+                                                          [state]{ state->pings += 1; }));
+            }
+            //  every client drops every few minutes and backs off again
+            state->reconnect = [state](int client, int attempt) {
+                state->reconnects += 1;
+                const double delay = attempt < 6 ? std::pow(2.0, attempt) : 180.0 + client % 60;
+                Sleep(TimeDuration(delay))->Then([state, client, attempt](None _) {
+                    if (!state->reconnect) { return; }
+                    state->reconnect(client, attempt < 6 ? attempt + 1 : 0);
+                });
+            };
+            for (int i = 0; i < clients; i++) {
+                state->reconnect(i, 0);
+            }
+        });
+        
+        const auto cpu_start = std::clock();
+        queue->RunFor(TimeDuration(minutes * 60));
+        const double cpu_us = 1000000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        
+        printf("[BenchVirtualTime] %d clients, %.0f minutes: %lld tasks, %lld pings, %lld reconnects, "
+               "%.0f us CPU / simulated minute\n",
+               clients, minutes,
+               (long long)queue->run_task_count(), (long long)state->pings, (long long)state->reconnects,
+               cpu_us / minutes);
+        
+        queue->PostTask([state]{
+            for (auto & heartbeat : state->heartbeats) {
+                heartbeat->Cancel();
+            }
+            state->heartbeats.clear();
+            state->reconnect = nullptr;
+        });
+        //  the backoff sleeps left resolve into the stopped chain
+        queue->RunUntilIdle();
+        ASSERT(queue->timer_service()->pending_count() == 0);
+    }
+    
+    void NwrTestSet::BenchWebsocketThreadLatency() {
+        const int samples = 2000;
+        
+        auto measure = [&](const char * name, int interval_us, const std::function<void(Task &&)> & post) {
+            std::vector<double> latencies(samples);
+            std::mutex mutex;
+            std::condition_variable done_cond;
+            int done = 0;
+            int i = 0;
+            const double post_us = Measure(samples, [&]{
+                auto posted = std::chrono::steady_clock::now();
+                post([&, i, posted]{
+                    latencies[i] = std::chrono::duration<double, std::micro>
+                    (std::chrono::steady_clock::now() - posted).count();
+                    std::lock_guard<std::mutex> lk(mutex);
+                    done += 1;
+                    done_cond.notify_one();
+                });
+                i += 1;
+                if (interval_us > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+                }
+            });
+            {
+                std::unique_lock<std::mutex> lk(mutex);
+                done_cond.wait(lk, [&]{ return done == samples; });
+            }
+            std::sort(latencies.begin(), latencies.end());
+            printf("[BenchWebsocketThreadLatency] %s: p50 %.1f us, p99 %.1f us, posted in %.0f us\n",
+                   name, latencies[samples / 2], latencies[samples * 99 / 100], post_us);
+        };
+        
+        lws_protocols protocols[2];
+        memset(protocols, 0, sizeof(protocols));
+        protocols[0].name = "default";
+        protocols[0].callback = [](lws *, lws_callback_reasons, void *, void *, size_t) { return 0; };
+        lws_context_creation_info info = { 0 };
+        info.port = CONTEXT_PORT_NO_LISTEN;
+        info.protocols = protocols;
+        info.gid = -1;
+        info.uid = -1;
+        lws_context * legacy_context = lws_create_context(&info);
+        auto legacy = std::make_shared<LegacyWebsocketThread>(legacy_context);
+        measure("mutex deque, idle", 200, [legacy](Task && task){ legacy->PostTask(std::move(task)); });
+        measure("mutex deque, burst", 0, [legacy](Task && task){ legacy->PostTask(std::move(task)); });
+        legacy->Quit();
+        lws_context_destroy(legacy_context);
+        
+        auto context = WebsocketContext::Shared(nullptr, false);
+        WebsocketThread * thread = context->thread();
+        measure("mpsc, idle", 200, [thread](Task && task){ thread->PostTask(std::move(task)); });
+        measure("mpsc, burst", 0, [thread](Task && task){ thread->PostTask(std::move(task)); });
+    }
+    
+    //  the former IosTaskQueue, as the reference of BenchTaskAllocation.
+    //  PostTask copied the std::function into a local, and the block capturing it
+    //  copied it again into its heap copy. the operation the block went into is left out
+    class LegacyTaskQueue {
+    public:
+        void PostTask(const std::function<void()> & task) {
+            std::function<void()> task_copy = task;
+            blocks_.push_back(std::unique_ptr<Block>(new Block { task_copy }));
+        }
+        void RunAll() {
+            for (auto & block : blocks_) {
+                block->task();
+            }
+            blocks_.clear();
+        }
+    private:
+        struct Block {
+            std::function<void()> task;
+        };
+        std::vector<std::unique_ptr<Block>> blocks_;
+    };
+    
+    void NwrTestSet::BenchTaskAllocation() {
+        const int count = 10000;
+        auto owner = std::make_shared<int>(0);
+        Websocket::Message message(std::string(64, 'a'));
+        
+        //  called on the main queue, so the tasks posted to it wait until this returns
+        //  and the blocks in use after posting are the allocations of the posts
+        auto queue = TaskQueue::current_queue();
+        LegacyTaskQueue legacy;
+        
+        auto measure = [&](const char * name, const std::function<void()> & post) {
+            malloc_statistics_t before, after;
+            malloc_zone_statistics(nullptr, &before);
+            const double us = Measure(count, post);
+            malloc_zone_statistics(nullptr, &after);
+            printf("[BenchTaskAllocation] %s: %.2f allocations / post, %.0f us\n",
+                   name, double(after.blocks_in_use - before.blocks_in_use) / count, us);
+        };
+        
+        //  the closure before Task, a std::function copied on each hop
+        measure("std::function", [&]{
+            auto thiz = owner;
+            legacy.PostTask([thiz, message]{ (void)message; });
+        });
+        measure("Task", [&]{
+            auto thiz = owner;
+            queue->PostTask(Task(NWR_HERE, [thiz = std::move(thiz), message]{ (void)message; }));
+        });
+        
+        //  every post still holds its owner, none of them ran
+        ASSERT(owner.use_count() == 1 + 2 * count);
+        legacy.RunAll();
+        ASSERT(owner.use_count() == 1 + count);
+    }
+    
+    void NwrTestSet::TestEmitter() {
+        Emitter<int> emitter;
+        std::vector<std::string> log;
+        auto a = EventListenerMake<int>([&](const int & x) { log.push_back(Format("a%d", x)); });
+        auto b = EventListenerMake<int>([&](const int & x) { log.push_back(Format("b%d", x)); });
+        emitter.Emit(0);
+        emitter.On(a);
+        emitter.Once(b);
+        emitter.Emit(1);
+        emitter.Emit(2);
+        ASSERT(log == (std::vector<std::string> { "a1", "b1", "a2" }));
+        
+        //  removed and added while emitting, so the snapshot runs as it was
+        log.clear();
+        auto c = EventListenerMake<int>([&](const int & x) {
+            log.push_back(Format("c%d", x));
+            emitter.Off(a);
+            emitter.On(b);
+        });
+        emitter.On(c);
+        emitter.Emit(3);
+        emitter.Emit(4);
+        ASSERT(log == (std::vector<std::string> { "a3", "c3", "c4", "b4" }));
+        
+        //  a nested Emit runs a Once listener, and the outer one skips it
+        Emitter<int> nested;
+        int once_count = 0;
+        nested.On([&](const int & x) {
+            if (x == 0) { nested.Emit(1); }
+        });
+        nested.Once([&](const int & x) { once_count += 1; });
+        nested.Emit(0);
+        ASSERT(once_count == 1);
+        
+        //  Off removes a Once listener before it runs
+        emitter.RemoveAllListeners();
+        log.clear();
+        emitter.Once(a);
+        emitter.Off(a);
+        emitter.Emit(5);
+        ASSERT(log.size() == 0);
+        ASSERT(emitter.listeners().size() == 0);
+    }
+    
+    void NwrTestSet::BenchEmitter() {
+        const int count = 1000000;
+        
+        auto measure = [&](const char * name, int listener_num, const std::function<void(Emitter<int> &)> & emit) {
+            Emitter<int> emitter;
+            int64_t sum = 0;
+            for (int i = 0; i < listener_num; i++) {
+                emitter.On([&sum](const int & x) { sum += x; });
+            }
+            const double us = Measure(count, [&]{ emit(emitter); });
+            printf("[BenchEmitter] %s, %d listeners: %.1f ns / emit\n", name, listener_num, us * 1000 / count);
+        };
+        
+        for (int listener_num : { 0, 1, 4 }) {
+            //  the former Emit, copying the listeners on every call
+            measure("copying", listener_num, [](Emitter<int> & emitter) {
+                for (auto listener : emitter.listeners()) {
+                    (*listener)(1);
+                }
+            });
+            measure("Emit", listener_num, [](Emitter<int> & emitter) {
+                emitter.Emit(1);
+            });
+        }
+    }
+    
     void NwrTestSet::TestSio() {
         
         eio::Socket::ConstructorParams params;
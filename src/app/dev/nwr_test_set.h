@@ -19,7 +19,31 @@ namespace app {
     class NwrTestSet {
     public:
         void TestAnyType();
+        void BenchJsonParse();
+        void BenchJsonFormat();
+        void BenchObjectMap();
+        void BenchAnyArena();
+        void TestBufferSlice();
+        void BenchBase64();
         void TestEio();
+        void TestWebsocketThreads();
+        void BenchWebsocketSend();
+        void TestWebsocketDeflate();
+        void TestWebsocketBackpressure();
+        void TestWebsocketReassembly();
+        void TestWebsocketStats();
+        void TestTimerService();
+        void TestPromise();
+        void TestWorkerStage();
+        void TestTaskInstrument();
+        void TestVirtualTimeQueue();
+        void TestEioHeartbeat();
+        void TestSio0CloseTimeout();
+        void TestEmitter();
+        void BenchWebsocketThreadLatency();
+        void BenchTaskAllocation();
+        void BenchVirtualTime();
+        void BenchEmitter();
         void TestSio();
         void TestSio0();
     };
@@ -12,40 +12,63 @@
 #include "array.h"
 #include "map.h"
 #include "json.h"
+#include "any_arena.h"
+
+#include <cstring>
 
 namespace nwr {
-    Any::Any(): type_(Type::Null), value_(nullptr) {}
-    Any::Any(const Any & copy): type_(Type::Null), value_(nullptr) {
+    Any::Any(): type_(Type::Null), number_(0), value_(nullptr) {}
+    Any::Any(const Any & copy): type_(Type::Null), number_(0), value_(nullptr) {
         *this = copy;
     }
-    Any::Any(Any && move): type_(Type::Null), value_(nullptr) {
-        *this = move;
+    Any::Any(Any && move): type_(Type::Null), number_(0), value_(nullptr) {
+        *this = std::move(move);
     }
+    Any::~Any() {}
     
-    Any::Any(std::nullptr_t value): type_(Type::Null), value_(nullptr) {}
+    Any::Any(std::nullptr_t value): type_(Type::Null), number_(0), value_(nullptr) {}
     
-    Any::Any(bool value): type_(Type::Boolean), value_(std::make_shared<bool>(value)) {}
+    Any::Any(bool value): type_(Type::Boolean), number_(0), value_(nullptr) {
+        boolean_ = value;
+    }
     
     Any::Any(int value): Any(static_cast<double>(value)){}
-    Any::Any(double value): type_(Type::Number), value_(std::make_shared<double>(value)) {}
+    Any::Any(double value): type_(Type::Number), number_(value), value_(nullptr) {}
     
-    Any::Any(const char * value): Any(std::string(value)) {};
-    Any::Any(const std::string & value): type_(Type::String), value_(std::make_shared<std::string>(value)) {}
+    Any::Any(const char * value): type_(Type::String), number_(0), value_(nullptr) {
+        SetString(value, static_cast<int>(strlen(value)));
+    }
+    Any::Any(const std::string & value): type_(Type::String), number_(0), value_(nullptr) {
+        SetString(value.c_str(), static_cast<int>(value.length()));
+    }
+    Any::Any(std::string && value): type_(Type::String), number_(0), value_(nullptr) {
+        if (value.length() <= kInlineStringCapacity) {
+            SetString(value.c_str(), static_cast<int>(value.length()));
+        } else {
+            value_ = MakeAnyShared<std::string>(std::move(value));
+        }
+    }
     
-    Any::Any(const Data & value): Any(std::make_shared<Data>(value)){}
-    Any::Any(const DataPtr & value): type_(Type::Data), value_(value) {}
+    Any::Any(const Data & value): Any(MakeAnyShared<Data>(value)){}
+    Any::Any(const DataPtr & value): type_(Type::Data), number_(0), value_(value) {}
     
     Any::Any(const ArrayType & value):
-    type_(Type::Array), value_(std::make_shared<ArrayType>(value)) {}
+    type_(Type::Array), number_(0), value_(MakeAnyShared<ArrayType>(value)) {}
+
+    Any::Any(ArrayType && value):
+    type_(Type::Array), number_(0), value_(MakeAnyShared<ArrayType>(std::move(value))) {}
 
     Any::Any(const ObjectType & value):
-    type_(Type::Object), value_(std::make_shared<ObjectType>(value)) {}
+    type_(Type::Object), number_(0), value_(MakeAnyShared<ObjectType>(value)) {}
+    
+    Any::Any(ObjectType && value):
+    type_(Type::Object), number_(0), value_(MakeAnyShared<ObjectType>(std::move(value))) {}
     
     Any::Any(const AnyFuncPtr & value):
-    type_(Type::Function), value_(value) {}
+    type_(Type::Function), number_(0), value_(value) {}
     
     Any::Any(const PointerType & value):
-    type_(Type::Pointer), value_(value) {}
+    type_(Type::Pointer), number_(0), value_(value) {}
     
     Any::Type Any::type() const {
         return type_;
@@ -54,9 +77,9 @@ namespace nwr {
     int Any::count() const {
         switch (type()) {
             case Type::Array:
-                return static_cast<int>(AsArray()->size());
+                return static_cast<int>(inner_array()->size());
             case Type::Object:
-                return static_cast<int>(AsObject()->size());
+                return static_cast<int>(inner_object()->size());
             default:
                 return 0;
         }
@@ -76,24 +99,28 @@ namespace nwr {
     
     Optional<bool> Any::AsBoolean() const {
         if (type() == Type::Boolean) {
-            return Some(*std::static_pointer_cast<bool>(value_));
+            return Some(boolean_);
         } else {
             return None();
         }
     }
     Optional<int> Any::AsInt() const {
-        return AsDouble().Map<int>([](double x) { return static_cast<int>(x); });
+        if (type() == Type::Number) {
+            return Some(static_cast<int>(number_));
+        } else {
+            return None();
+        }
     }
     Optional<double> Any::AsDouble() const {
         if (type() == Type::Number) {
-            return Some(*std::static_pointer_cast<double>(value_));
+            return Some(number_);
         } else {
             return None();
         }
     }
     Optional<std::string> Any::AsString() const {
         if (type() == Type::String) {
-            return Some(*std::static_pointer_cast<std::string>(value_));
+            return Some(std::string(string_chars(), string_size()));
         } else {
             return None();
         }
@@ -113,6 +140,12 @@ namespace nwr {
         auto dict = inner_object();
         return dict ? Some(*dict) : None();
     }
+    const Any::ArrayType * Any::AsArrayPointer() const {
+        return inner_array();
+    }
+    const Any::ObjectType * Any::AsObjectPointer() const {
+        return inner_object();
+    }
     
     Optional<AnyFuncPtr> Any::AsFunction() const {
         if (type() == Type::Function) {
@@ -131,50 +164,46 @@ namespace nwr {
     }
     
     Any & Any::operator= (const Any & copy) {
-        type_ = copy.type_;
-        
-        switch (type_) {
-            case Type::Null:
-                value_ = nullptr;
-                break;
-            case Type::Boolean:
-                value_ = std::make_shared<bool>(*copy.AsBoolean());
-                break;
-            case Type::Number:
-                value_ = std::make_shared<double>(*copy.AsDouble());
-                break;
-            case Type::String:
-                value_ = std::make_shared<std::string>(*copy.AsString());
-                break;
-            case Type::Data:
-            case Type::Array:
-            case Type::Object:
-            case Type::Function:
-            case Type::Pointer:
-                value_ = copy.value_;
-                break;
+        if (this == &copy) {
+            return *this;
         }
         
+        type_ = copy.type_;
+        CopyScalar(copy);
+        //  long strings are immutable, so the body is shared like ref types
+        value_ = copy.value_;
+        
         return *this;
     }
     Any & Any::operator= (Any && move) {
+        if (this == &move) {
+            return *this;
+        }
+        
         type_ = move.type_;
-        value_ = move.value_;
+        CopyScalar(move);
+        value_ = std::move(move.value_);
         move.type_ = Type::Null;
         move.value_ = nullptr;
         return *this;
     }
     
     bool Any::operator== (const Any & cmp) const {
+        if (type_ != cmp.type_) {
+            return false;
+        }
         switch (type_) {
             case Type::Null:
-                return cmp.type() == Type::Null;
+                return true;
             case Type::Boolean:
-                return AsBoolean() == cmp.AsBoolean();
+                return boolean_ == cmp.boolean_;
             case Type::Number:
-                return AsDouble() == cmp.AsDouble();
-            case Type::String:
-                return AsString() == cmp.AsString();
+                return number_ == cmp.number_;
+            case Type::String: {
+                const int size = string_size();
+                return size == cmp.string_size() &&
+                memcmp(string_chars(), cmp.string_chars(), size) == 0;
+            }
             case Type::Data:
             case Type::Array:
             case Type::Object:
@@ -191,27 +220,25 @@ namespace nwr {
     Any Any::Clone() const {
         switch (type_) {
             case Type::Null:
-                return Any();
             case Type::Boolean:
-                return Any(*AsBoolean());
             case Type::Number:
-                return Any(*AsDouble());
             case Type::String:
-                return Any(*AsString());
+                return *this;
             case Type::Data:
-                return Any(std::make_shared<Data>(**AsData()));
+                return Any(MakeAnyShared<Data>(**AsData()));
             case Type::Array: {
-                std::vector<Any> array = Map(*AsArray(), [](const Any & x) -> Any {
+                std::vector<Any> array = Map(*inner_array(), [](const Any & x) -> Any {
                     return x.Clone();
                 });
                 return Any(array);
             }
             case Type::Object: {
-                std::map<std::string, Any> map =
-                MapToMap(*AsObject(), [](const std::string & key, const Any & x) {
-                    return std::pair<std::string, Any>(key, x.Clone());
-                });
-                return Any(map);
+                ObjectType map;
+                map.reserve(count());
+                for (const auto & entry : *inner_object()) {
+                    map.insert(ObjectType::value_type(entry.first, entry.second.Clone()));
+                }
+                return Any(std::move(map));
             }
             case Type::Function:
                 return Any(*AsFunction());
@@ -239,31 +266,75 @@ namespace nwr {
         (*array)[index] = value;
     }
     
-    Any Any::GetAt(const std::string & key) const {
-        auto dict = inner_object();
-        if (dict) {
-            if (HasKey(key)) {
-                return (*dict)[key];
+    namespace {
+        //  a string key is compared with the keys by string, so it is not made into an Atom
+        template <typename K>
+        Any GetAtKey(const Any::ObjectType * dict, const K & key) {
+            if (dict) {
+                auto iter = dict->find(key);
+                if (iter != dict->end()) {
+                    return iter->second;
+                }
             }
+            return nullptr;
         }
-        return nullptr;
+        
+        template <typename K>
+        bool HasKeyAt(const Any::ObjectType * dict, const K & key) {
+            if (dict) {
+                return dict->find(key) != dict->end();
+            }
+            return false;
+        }
+    }
+    
+    Any Any::GetAt(const char * key) const {
+        return GetAt(std::string(key));
+    }
+    Any Any::GetAt(const std::string & key) const {
+        return GetAtKey(inner_object(), key);
+    }
+    Any Any::GetAt(const Atom & key) const {
+        return GetAtKey(inner_object(), key);
     }
     void Any::SetAt(const std::string & key, const Any & value) {
+        SetAt(Atom(key), value);
+    }
+    void Any::SetAt(const Atom & key, const Any & value) {
         auto dict = inner_object();
         if (!dict) { Fatal("not dictionary"); }
         (*dict)[key] = value;
     }
     void Any::RemoveAt(const std::string & key) {
+        auto dict = inner_object();
+        if (!dict) { Fatal("not dictionary"); }
+        auto iter = dict->find(key);
+        if (iter != dict->end()) {
+            dict->erase(iter);
+        }
+    }
+    void Any::RemoveAt(const Atom & key) {
         auto dict = inner_object();
         if (!dict) { Fatal("not dictionary"); }
         (*dict).erase(key);
     }
+    bool Any::HasKey(const char * key) const {
+        return HasKey(std::string(key));
+    }
     bool Any::HasKey(const std::string & key) const {
+        return HasKeyAt(inner_object(), key);
+    }
+    bool Any::HasKey(const Atom & key) const {
+        return HasKeyAt(inner_object(), key);
+    }
+    void Any::ForEach(const std::function<void(const std::string &, const Any &)> & f) const {
         auto dict = inner_object();
-        if (dict) {
-            return nwr::HasKey(*dict, key);
+        if (!dict) {
+            return;
+        }
+        for (const auto & entry : *dict) {
+            f(entry.first.str(), entry.second);
         }
-        return false;
     }
     
     std::shared_ptr<Json::Value> Any::ToJson() const {
@@ -280,15 +351,15 @@ namespace nwr {
                 return std::make_shared<Json::Value>(Format("<Data %s>", DataFormat(**AsData()).c_str()));
             case Type::Array: {
                 auto json = std::make_shared<Json::Value>(Json::arrayValue);
-                for (int i = 0; i < count(); i++) {
-                    json->append(*GetAt(i).ToJson());
+                for (const auto & element : *inner_array()) {
+                    json->append(*element.ToJson());
                 }
                 return json;
             }
             case Type::Object: {
                 auto json = std::make_shared<Json::Value>(Json::objectValue);
-                for (auto key : keys()) {
-                    (*json)[key] = *GetAt(key).ToJson();
+                for (const auto & entry : *inner_object()) {
+                    (*json)[entry.first.str()] = *entry.second.ToJson();
                 }
                 return json;
             }
@@ -335,7 +406,7 @@ namespace nwr {
             case Json::objectValue: {
                 ObjectType dict;
                 for (auto key : json.getMemberNames()) {
-                    dict[key] = FromJson(json.get(key, Json::Value()));
+                    dict[Atom(key)] = FromJson(json.get(key, Json::Value()));
                 }
                 return Any(dict);
             }
@@ -343,24 +414,79 @@ namespace nwr {
     }
     
     std::string Any::ToJsonString() const {
-        return JsonFormat(*ToJson());
+        return JsonFormatAny(*this);
     }
     Any Any::FromJsonString(const std::string & str) {
-        auto json = JsonParse(str);
-        if (!json) { return nullptr; }
-        return FromJson(*json);
+        Any ret;
+        if (!JsonParseAny(AsDataPointer(str), static_cast<int>(str.length()), ret)) {
+            return nullptr;
+        }
+        return ret;
+    }
+    
+    void Any::SetString(const char * chars, int size) {
+        if (size <= kInlineStringCapacity) {
+            inline_string_.size = static_cast<uint8_t>(size);
+            memcpy(inline_string_.chars, chars, size);
+            value_ = nullptr;
+        } else {
+            value_ = MakeAnyShared<std::string>(chars, size);
+        }
+    }
+    //  copies only the member of the union that the type of other uses
+    void Any::CopyScalar(const Any & other) {
+        switch (other.type_) {
+            case Type::Boolean:
+                boolean_ = other.boolean_;
+                break;
+            case Type::Number:
+                number_ = other.number_;
+                break;
+            case Type::String:
+                if (other.is_inline_string()) {
+                    inline_string_ = other.inline_string_;
+                } else {
+                    number_ = 0;
+                }
+                break;
+            case Type::Null:
+            case Type::Data:
+            case Type::Array:
+            case Type::Object:
+            case Type::Function:
+            case Type::Pointer:
+                number_ = 0;
+                break;
+        }
+    }
+    bool Any::is_inline_string() const {
+        return type() == Type::String && !value_;
+    }
+    const char * Any::string_chars() const {
+        if (is_inline_string()) {
+            return inline_string_.chars;
+        } else {
+            return static_cast<const std::string *>(value_.get())->c_str();
+        }
+    }
+    int Any::string_size() const {
+        if (is_inline_string()) {
+            return inline_string_.size;
+        } else {
+            return static_cast<int>(static_cast<const std::string *>(value_.get())->length());
+        }
     }
     
-    std::shared_ptr<Any::ArrayType> Any::inner_array() const {
+    Any::ArrayType * Any::inner_array() const {
         if (type() == Type::Array) {
-            return std::static_pointer_cast<ArrayType>(value_);
+            return static_cast<ArrayType *>(value_.get());
         } else {
             return nullptr;
         }
     }
-    std::shared_ptr<Any::ObjectType> Any::inner_object() const {
+    Any::ObjectType * Any::inner_object() const {
         if (type() == Type::Object) {
-            return std::static_pointer_cast<Any::ObjectType>(value_);
+            return static_cast<Any::ObjectType *>(value_.get());
         } else {
             return nullptr;
         }
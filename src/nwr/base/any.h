@@ -12,10 +12,13 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <functional>
 
 #include "data.h"
 #include "optional.h"
 #include "func.h"
+#include "flat_map.h"
+#include "atom.h"
 #include "any_func_forward.h"
 
 namespace Json {
@@ -23,10 +26,15 @@ namespace Json {
 }
 
 namespace nwr {
+    template <typename Buffer> class JsonAnyWriter;
+    
     class Any {
     public:
+        //  strings up to this length are stored in the Any itself
+        static constexpr int kInlineStringCapacity = 22;
+        
         using ArrayType = std::vector<Any>;
-        using ObjectType = std::map<std::string, Any>;
+        using ObjectType = FlatMap<Atom, Any>;
         using PointerType = std::shared_ptr<void>;
         
         enum class Type {
@@ -45,6 +53,7 @@ namespace nwr {
         Any();
         Any(const Any & copy);
         Any(Any && move);
+        ~Any();
         
         Any(std::nullptr_t value);
         explicit Any(bool value);
@@ -52,10 +61,13 @@ namespace nwr {
         explicit Any(double value);
         explicit Any(const char * value);
         explicit Any(const std::string & value);
+        explicit Any(std::string && value);
         explicit Any(const Data & value);
         explicit Any(const DataPtr & value);
         explicit Any(const ArrayType & value);
+        explicit Any(ArrayType && value);
         explicit Any(const ObjectType & value);
+        explicit Any(ObjectType && value);
         Any(const AnyFuncPtr & value);
         explicit Any(const PointerType & value);
         template <typename T> explicit Any(const Optional<T> & value):
@@ -75,6 +87,10 @@ namespace nwr {
         Optional<DataPtr> AsData() const;
         Optional<ArrayType> AsArray() const;
         Optional<ObjectType> AsObject() const;
+        //  borrowed views of the container, null if type mismatch.
+        //  valid while this value is alive and not modified.
+        const ArrayType * AsArrayPointer() const;
+        const ObjectType * AsObjectPointer() const;
         Optional<AnyFuncPtr> AsFunction() const;
         Optional<PointerType> AsPointer() const;
         
@@ -90,10 +106,21 @@ namespace nwr {
         Any GetAt(int index) const;
         void SetAt(int index, const Any & value);
         
+        //  symbol keys are compared by the pointer of Atom, others by string.
+        //  a string key is looked up without making an Atom of it.
+        Any GetAt(const char * key) const;
         Any GetAt(const std::string & key) const;
+        Any GetAt(const Atom & key) const;
         void SetAt(const std::string & key, const Any & value);
+        void SetAt(const Atom & key, const Any & value);
         void RemoveAt(const std::string & key);
+        void RemoveAt(const Atom & key);
+        bool HasKey(const char * key) const;
         bool HasKey(const std::string & key) const;
+        bool HasKey(const Atom & key) const;
+        
+        //  visit entries in key order without copying the object
+        void ForEach(const std::function<void(const std::string &, const Any &)> & f) const;
         
         std::shared_ptr<Json::Value> ToJson() const;
         static Any FromJson(const Json::Value & json);
@@ -101,10 +128,31 @@ namespace nwr {
         std::string ToJsonString() const;
         static Any FromJsonString(const std::string & str);
     private:
-        std::shared_ptr<ArrayType> inner_array() const;
-        std::shared_ptr<ObjectType> inner_object() const;
+        template <typename Buffer> friend class JsonAnyWriter;
+        
+        struct InlineString {
+            uint8_t size;
+            char chars[kInlineStringCapacity];
+        };
         
+        ArrayType * inner_array() const;
+        ObjectType * inner_object() const;
+        
+        void SetString(const char * chars, int size);
+        void CopyScalar(const Any & other);
+        bool is_inline_string() const;
+        const char * string_chars() const;
+        int string_size() const;
+        
+        //  Null, Boolean, Number and short String live in the union.
+        //  value_ holds the referenced object of Data, Array, Object, Function, Pointer
+        //  and the immutable shared body of a long String.
         Type type_;
+        union {
+            bool boolean_;
+            double number_;
+            InlineString inline_string_;
+        };
         std::shared_ptr<void> value_;
     };
 
@@ -0,0 +1,134 @@
+//
+//  any_arena.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "any_arena.h"
+#include "any.h"
+
+namespace nwr {
+    namespace {
+        thread_local AnyArena * current_arena = nullptr;
+
+        std::atomic<bool> count_enabled(false);
+        std::atomic<int64_t> heap_count(0);
+        std::atomic<int64_t> arena_count(0);
+    }
+
+    AnyArena::AnyArena():
+    head_(nullptr),
+    remaining_(0),
+    allocated_size_(0)
+    {}
+
+    AnyArena::~AnyArena() {}
+
+    void * AnyArena::Allocate(size_t size, size_t align) {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(head_) % align) % align;
+        if (remaining_ < padding + size) {
+            //  large bodies get a chunk of their own and keep the current one
+            if (size + align > kChunkSize / 4) {
+                chunks_.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[size + align]));
+                uint8_t * chunk = chunks_.back().get();
+                allocated_size_ += size + align;
+                return chunk + (align - reinterpret_cast<uintptr_t>(chunk) % align) % align;
+            }
+            chunks_.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[kChunkSize]));
+            head_ = chunks_.back().get();
+            remaining_ = kChunkSize;
+            allocated_size_ += kChunkSize;
+            padding = (align - reinterpret_cast<uintptr_t>(head_) % align) % align;
+        }
+        void * p = head_ + padding;
+        head_ += padding + size;
+        remaining_ -= padding + size;
+        return p;
+    }
+
+    size_t AnyArena::allocated_size() const {
+        return allocated_size_;
+    }
+
+    AnyArena * AnyArena::current() {
+        return current_arena;
+    }
+
+    AnyArena::Scope::Scope(const std::shared_ptr<AnyArena> & arena):
+    arena_(arena),
+    outer_(current_arena)
+    {
+        current_arena = arena_.get();
+    }
+
+    AnyArena::Scope::~Scope() {
+        current_arena = outer_;
+    }
+    
+    bool IsAnyAllocationCountEnabled() {
+        return count_enabled.load(std::memory_order_relaxed);
+    }
+    
+    void SetAnyAllocationCountEnabled(bool value) {
+        count_enabled.store(value, std::memory_order_relaxed);
+    }
+
+    AnyAllocationStats GetAnyAllocationStats() {
+        AnyAllocationStats stats;
+        stats.heap_count = heap_count.load(std::memory_order_relaxed);
+        stats.arena_count = arena_count.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void ResetAnyAllocationStats() {
+        heap_count.store(0, std::memory_order_relaxed);
+        arena_count.store(0, std::memory_order_relaxed);
+    }
+
+    void CountAnyAllocation(bool arena) {
+        if (arena) {
+            arena_count.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            heap_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    namespace {
+        //  unlike Any::Clone, also copies long strings since their body may be in the arena
+        Any Promote(const Any & value) {
+            switch (value.type()) {
+                case Any::Type::String:
+                    return Any(*value.AsString());
+                case Any::Type::Data:
+                    return Any(**value.AsData());
+                case Any::Type::Array: {
+                    const auto & array = *value.AsArrayPointer();
+                    Any::ArrayType copy;
+                    copy.reserve(array.size());
+                    for (const auto & element : array) {
+                        copy.push_back(Promote(element));
+                    }
+                    return Any(std::move(copy));
+                }
+                case Any::Type::Object: {
+                    const auto & object = *value.AsObjectPointer();
+                    Any::ObjectType copy;
+                    copy.reserve(object.size());
+                    for (const auto & entry : object) {
+                        copy.insert(Any::ObjectType::value_type(entry.first, Promote(entry.second)));
+                    }
+                    return Any(std::move(copy));
+                }
+                default:
+                    return value;
+            }
+        }
+    }
+    
+    Any PromoteFromArena(const Any & value) {
+        AnyArena::Scope heap_scope(nullptr);
+        return Promote(value);
+    }
+}
@@ -0,0 +1,110 @@
+//
+//  any_arena.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+namespace nwr {
+    class Any;
+
+    //  monotonic buffer for the bodies of Any values built while decoding one packet.
+    //  while a Scope is active on a thread, Any allocates its shared bodies
+    //  (Array, Object, Data, long String) here instead of the heap.
+    //  every body keeps the arena alive, so a value that outlives the packet is safe,
+    //  but it pins the whole arena. use PromoteFromArena for values kept long.
+    //  container elements and string characters are still on the heap.
+    class AnyArena : public std::enable_shared_from_this<AnyArena> {
+    public:
+        static constexpr size_t kChunkSize = 4096;
+
+        AnyArena();
+        ~AnyArena();
+
+        void * Allocate(size_t size, size_t align);
+        size_t allocated_size() const;
+
+        //  arena of this thread, or null
+        static AnyArena * current();
+
+        class Scope {
+        public:
+            //  nullptr suspends the outer scope
+            explicit Scope(const std::shared_ptr<AnyArena> & arena);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope & operator= (const Scope &) = delete;
+        private:
+            std::shared_ptr<AnyArena> arena_;
+            AnyArena * outer_;
+        };
+    private:
+        std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+        uint8_t * head_;
+        size_t remaining_;
+        size_t allocated_size_;
+    };
+
+    template <typename T>
+    class AnyArenaAllocator {
+    public:
+        using value_type = T;
+
+        explicit AnyArenaAllocator(const std::shared_ptr<AnyArena> & arena): arena_(arena) {}
+        template <typename U> AnyArenaAllocator(const AnyArenaAllocator<U> & copy): arena_(copy.arena()) {}
+
+        T * allocate(size_t n) {
+            return static_cast<T *>(arena_->Allocate(n * sizeof(T), alignof(T)));
+        }
+        //  released together with the arena
+        void deallocate(T * p, size_t n) {}
+
+        const std::shared_ptr<AnyArena> & arena() const { return arena_; }
+
+        template <typename U> bool operator== (const AnyArenaAllocator<U> & cmp) const {
+            return arena_ == cmp.arena();
+        }
+        template <typename U> bool operator!= (const AnyArenaAllocator<U> & cmp) const {
+            return !(*this == cmp);
+        }
+    private:
+        std::shared_ptr<AnyArena> arena_;
+    };
+
+    //  counters of the Any bodies made on the heap and in arenas, for measurement.
+    //  off by default; while off, a body costs one atomic load more.
+    //  they count bodies only, not the elements and characters inside them
+    struct AnyAllocationStats {
+        int64_t heap_count;
+        int64_t arena_count;
+    };
+    bool IsAnyAllocationCountEnabled();
+    void SetAnyAllocationCountEnabled(bool value);
+    AnyAllocationStats GetAnyAllocationStats();
+    void ResetAnyAllocationStats();
+    void CountAnyAllocation(bool arena);
+
+    template <typename T, typename... Args>
+    std::shared_ptr<T> MakeAnyShared(Args &&... args) {
+        AnyArena * arena = AnyArena::current();
+        const bool count = IsAnyAllocationCountEnabled();
+        if (arena) {
+            if (count) { CountAnyAllocation(true); }
+            return std::allocate_shared<T>(AnyArenaAllocator<T>(arena->shared_from_this()),
+                                           std::forward<Args>(args)...);
+        }
+        if (count) { CountAnyAllocation(false); }
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+
+    //  deep copy to the heap, to keep a value after its packet is handled
+    Any PromoteFromArena(const Any & value);
+}
@@ -0,0 +1,88 @@
+//
+//  atom.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "atom.h"
+
+#include <unordered_set>
+
+namespace nwr {
+    namespace {
+        //  built once and never modified, so lookups need no lock
+        const std::unordered_set<std::string> & SymbolTable() {
+            static const std::unordered_set<std::string> table {
+                //  easyrtc
+                "msgType", "msgData", "senderEasyrtcid", "targetEasyrtcid",
+                "targetRoom", "targetGroup", "easyrtcid", "easyrtcsid",
+                "roomName", "roomData", "roomStatus", "roomJoin", "roomList",
+                "clientList", "clientListDelta", "updateClient", "removeClient",
+                "field", "fieldName", "fieldValue", "apiField", "presence",
+                "show", "status", "username", "serverTime", "roomJoinTime",
+                "errorCode", "errorText", "sessionData", "iceConfig", "iceServers",
+                "url", "urls", "credential", "application", "mediaIds",
+                //  webrtc signaling
+                "type", "sdp", "candidate", "label", "id", "sdpMid", "sdpMLineIndex",
+                //  socket.io
+                "_placeholder", "num", "name", "args",
+                //  the default Atom
+                ""
+            };
+            return table;
+        }
+
+        const std::string * FindSymbol(const std::string & value) {
+            const auto & table = SymbolTable();
+            auto iter = table.find(value);
+            if (iter == table.end()) {
+                return nullptr;
+            }
+            return &*iter;
+        }
+    }
+
+    Atom::Atom() {
+        static const std::string * const empty = FindSymbol(std::string());
+        symbol_ = empty;
+    }
+
+    Atom::Atom(const char * value): Atom(std::string(value)) {}
+    
+    Atom::Atom(const std::string & value): symbol_(FindSymbol(value)) {
+        if (!symbol_) {
+            value_ = value;
+        }
+    }
+    
+    Atom::Atom(std::string && value): symbol_(FindSymbol(value)) {
+        if (!symbol_) {
+            value_ = std::move(value);
+        }
+    }
+
+    namespace atoms {
+        const Atom kMsgType("msgType");
+        const Atom kMsgData("msgData");
+        const Atom kSenderEasyrtcid("senderEasyrtcid");
+        const Atom kTargetEasyrtcid("targetEasyrtcid");
+        const Atom kTargetRoom("targetRoom");
+        const Atom kTargetGroup("targetGroup");
+        const Atom kEasyrtcid("easyrtcid");
+        const Atom kRoomName("roomName");
+        const Atom kRoomData("roomData");
+        const Atom kRoomStatus("roomStatus");
+        const Atom kClientList("clientList");
+        const Atom kClientListDelta("clientListDelta");
+        const Atom kField("field");
+        const Atom kErrorCode("errorCode");
+        const Atom kErrorText("errorText");
+        const Atom kServerTime("serverTime");
+        const Atom kPlaceholder("_placeholder");
+        const Atom kNum("num");
+        const Atom kName("name");
+        const Atom kArgs("args");
+    }
+}
@@ -0,0 +1,98 @@
+//
+//  atom.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "flat_map.h"
+
+namespace nwr {
+    //  object key of Any.
+    //  a key in the fixed symbol table is a pointer into it, so symbols compare by pointer.
+    //  any other key, like an easyrtc id or a room name, owns its string and compares by value,
+    //  so nothing outlives the objects that hold it.
+    //  the symbol table is built once and looked up without a lock.
+    class Atom {
+    public:
+        //  the empty string
+        Atom();
+        explicit Atom(const char * value);
+        explicit Atom(const std::string & value);
+        explicit Atom(std::string && value);
+
+        const std::string & str() const { return symbol_ ? *symbol_ : value_; }
+        //  in the fixed symbol table
+        bool is_symbol() const { return symbol_ != nullptr; }
+        explicit operator const std::string & () const { return str(); }
+        
+        //  a string in the symbol table is always a symbol,
+        //  so a symbol never equals an owned key
+        bool operator== (const Atom & cmp) const {
+            if (symbol_ || cmp.symbol_) {
+                return symbol_ == cmp.symbol_;
+            }
+            return value_ == cmp.value_;
+        }
+        bool operator!= (const Atom & cmp) const { return !(*this == cmp); }
+        //  by string, so objects keep their keys in string order
+        bool operator< (const Atom & cmp) const {
+            return !(symbol_ && symbol_ == cmp.symbol_) && str() < cmp.str();
+        }
+
+        bool operator== (const std::string & cmp) const { return str() == cmp; }
+        bool operator!= (const std::string & cmp) const { return str() != cmp; }
+        bool operator< (const std::string & cmp) const { return str() < cmp; }
+        bool operator== (const char * cmp) const { return str() == cmp; }
+        bool operator!= (const char * cmp) const { return str() != cmp; }
+        bool operator< (const char * cmp) const { return str().compare(cmp) < 0; }
+    private:
+        //  in the symbol table, or nullptr for an owned value_
+        const std::string * symbol_;
+        std::string value_;
+    };
+
+    inline bool operator< (const std::string & a, const Atom & b) {
+        return a < b.str();
+    }
+
+    template <typename V>
+    std::vector<std::string> Keys(const FlatMap<Atom, V> & map) {
+        std::vector<std::string> r;
+        r.reserve(map.size());
+        for (const auto & pair : map) {
+            r.push_back(pair.first.str());
+        }
+        return r;
+    }
+
+    //  symbols of easyrtc and socket.io messages
+    namespace atoms {
+        extern const Atom kMsgType;
+        extern const Atom kMsgData;
+        extern const Atom kSenderEasyrtcid;
+        extern const Atom kTargetEasyrtcid;
+        extern const Atom kTargetRoom;
+        extern const Atom kTargetGroup;
+        extern const Atom kEasyrtcid;
+        extern const Atom kRoomName;
+        extern const Atom kRoomData;
+        extern const Atom kRoomStatus;
+        extern const Atom kClientList;
+        extern const Atom kClientListDelta;
+        extern const Atom kField;
+        extern const Atom kErrorCode;
+        extern const Atom kErrorText;
+        extern const Atom kServerTime;
+        extern const Atom kPlaceholder;
+        extern const Atom kNum;
+        extern const Atom kName;
+        extern const Atom kArgs;
+    }
+}
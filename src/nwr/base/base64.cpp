@@ -8,35 +8,230 @@
 
 #include "base64.h"
 
-#include <openssl/ssl.h>
+#include <algorithm>
 
-#include "env.h"
-#include "string.h"
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#   define NWR_BASE64_NEON 1
+#   include <arm_neon.h>
+#elif defined(__SSSE3__)
+#   define NWR_BASE64_SSSE3 1
+#   include <tmmintrin.h>
+#endif
 
 namespace nwr {
+    namespace {
+        const uint8_t kEncodeTable[64] = {
+            'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+            'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+            'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+            'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+            '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+        };
+
+        const uint8_t kInvalid = 0xff;
+
+        //  0xff for characters out of the alphabet, including '='
+        struct DecodeTable {
+            uint8_t values[256];
+            DecodeTable() {
+                for (int i = 0; i < 256; i++) {
+                    values[i] = kInvalid;
+                }
+                for (int i = 0; i < 64; i++) {
+                    values[kEncodeTable[i]] = static_cast<uint8_t>(i);
+                }
+            }
+        };
+        const DecodeTable kDecodeTable;
+
+        //  whole 3 byte groups by SIMD. returns the number of bytes consumed.
+#if NWR_BASE64_NEON
+        int EncodeBlocks(const uint8_t * src, int size, uint8_t * dest) {
+            int i = 0;
+            const uint8x16x4_t table = {{
+                vld1q_u8(kEncodeTable), vld1q_u8(kEncodeTable + 16),
+                vld1q_u8(kEncodeTable + 32), vld1q_u8(kEncodeTable + 48)
+            }};
+            const uint8x16_t mask = vdupq_n_u8(0x3f);
+            for (; i + 48 <= size; i += 48, dest += 64) {
+                const uint8x16x3_t in = vld3q_u8(src + i);
+                uint8x16x4_t out;
+                out.val[0] = vshrq_n_u8(in.val[0], 2);
+                out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+                out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+                out.val[3] = vandq_u8(in.val[2], mask);
+                for (int k = 0; k < 4; k++) {
+                    out.val[k] = vqtbl4q_u8(table, out.val[k]);
+                }
+                vst4q_u8(dest, out);
+            }
+            return i;
+        }
+#elif NWR_BASE64_SSSE3
+        int EncodeBlocks(const uint8_t * src, int size, uint8_t * dest) {
+            int i = 0;
+            //  loads 16 bytes and uses 12 of them
+            const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            const __m128i shift_table = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                      '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            for (; i + 16 <= size; i += 12, dest += 16) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                in = _mm_shuffle_epi8(in, shuffle);
+
+                //  spread 3 bytes over 4 lanes of 6 bits
+                const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+                const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+                const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+                const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+                const __m128i indices = _mm_or_si128(t1, t3);
+
+                //  map each range of the alphabet to its offset
+                __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+                const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+                offsets = _mm_or_si128(offsets, _mm_and_si128(less, _mm_set1_epi8(13)));
+                const __m128i out = _mm_add_epi8(_mm_shuffle_epi8(shift_table, offsets), indices);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), out);
+            }
+            return i;
+        }
+#else
+        int EncodeBlocks(const uint8_t *, int, uint8_t *) {
+            return 0;
+        }
+#endif
+
+        //  whole 4 character groups by SIMD. returns the number of characters consumed.
+        //  stops before a group with an invalid character and leaves it to the scalar loop.
+#if NWR_BASE64_NEON
+        //  writes 48 bytes for 64 characters, so it stays within dest_size by itself
+        int DecodeBlocks(const uint8_t * src, int size, uint8_t * dest, int) {
+            int i = 0;
+            const uint8x16x4_t low_table = {{
+                vld1q_u8(kDecodeTable.values), vld1q_u8(kDecodeTable.values + 16),
+                vld1q_u8(kDecodeTable.values + 32), vld1q_u8(kDecodeTable.values + 48)
+            }};
+            const uint8x16x4_t high_table = {{
+                vld1q_u8(kDecodeTable.values + 64), vld1q_u8(kDecodeTable.values + 80),
+                vld1q_u8(kDecodeTable.values + 96), vld1q_u8(kDecodeTable.values + 112)
+            }};
+            const uint8x16_t offset = vdupq_n_u8(64);
+            for (; i + 64 <= size; i += 64, dest += 48) {
+                const uint8x16x4_t in = vld4q_u8(src + i);
+                uint8x16x4_t values;
+                uint8x16_t error = vdupq_n_u8(0);
+                for (int k = 0; k < 4; k++) {
+                    //  characters of 128 and more are out of both tables and get 0,
+                    //  so they are caught by their own high bit
+                    values.val[k] = vqtbx4q_u8(vqtbl4q_u8(low_table, in.val[k]),
+                                               high_table, vsubq_u8(in.val[k], offset));
+                    error = vorrq_u8(error, vorrq_u8(values.val[k], in.val[k]));
+                }
+                if (vmaxvq_u8(error) & 0x80) {
+                    break;
+                }
+                uint8x16x3_t out;
+                out.val[0] = vorrq_u8(vshlq_n_u8(values.val[0], 2), vshrq_n_u8(values.val[1], 4));
+                out.val[1] = vorrq_u8(vshlq_n_u8(values.val[1], 4), vshrq_n_u8(values.val[2], 2));
+                out.val[2] = vorrq_u8(vshlq_n_u8(values.val[2], 6), values.val[3]);
+                vst3q_u8(dest, out);
+            }
+            return i;
+        }
+#elif NWR_BASE64_SSSE3
+        int DecodeBlocks(const uint8_t * src, int size, uint8_t * dest, int dest_size) {
+            int i = 0;
+            //  stores 16 bytes and advances 12
+            const __m128i low_table = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+            const __m128i high_table = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                     0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m128i roll_table = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                                     0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+            for (int o = 0; i + 16 <= size && o + 16 <= dest_size; i += 16, o += 12, dest += 12) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                const __m128i high = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+                const __m128i low = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+
+                //  a bit shared by the entries of both nibbles marks an invalid character
+                const __m128i classes = _mm_and_si128(_mm_shuffle_epi8(low_table, low),
+                                                      _mm_shuffle_epi8(high_table, high));
+                if (_mm_movemask_epi8(_mm_cmpgt_epi8(classes, _mm_setzero_si128())) != 0) {
+                    break;
+                }
+
+                const __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+                const __m128i roll = _mm_shuffle_epi8(roll_table, _mm_add_epi8(slash, high));
+                const __m128i values = _mm_add_epi8(in, roll);
+
+                //  join 4 lanes of 6 bits into 3 bytes
+                const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+                const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+                const __m128i out = _mm_shuffle_epi8(groups, pack);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), out);
+            }
+            return i;
+        }
+#else
+        int DecodeBlocks(const uint8_t *, int, uint8_t *, int) {
+            return 0;
+        }
+#endif
+    }
+
+    int Base64CalcEncodedSize(int size) {
+        return (size + 2) / 3 * 4;
+    }
+
     void Base64Encode(const Data & data, Data & dest_str) {
-        BIO * bio = BIO_new(BIO_s_mem());
-        
-        BIO * base64 = BIO_new(BIO_f_base64());
-        bio = BIO_push(base64, bio);
-        
-        BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-        BIO_write(bio, &data[0], (int)data.size());
-        BIO_flush(bio);
-        
-        BUF_MEM * buf_mem;
-        BIO_get_mem_ptr(bio, &buf_mem);
-        
-        dest_str.resize(buf_mem->length);
-        std::copy(buf_mem->data, buf_mem->data + buf_mem->length, dest_str.begin());
-        
-        BIO_free_all(bio);
+        Base64Encode(data.data(), static_cast<int>(data.size()), dest_str);
+    }
+
+    void Base64Encode(const BufferSlice & data, Data & dest_str) {
+        Base64Encode(data.ptr(), data.size(), dest_str);
+    }
+
+    void Base64Encode(const uint8_t * data, int size, Data & dest_str) {
+        dest_str.resize(Base64CalcEncodedSize(size));
+        uint8_t * dest = dest_str.data();
+
+        int i = EncodeBlocks(data, size, dest);
+        dest += i / 3 * 4;
+
+        for (; i + 3 <= size; i += 3, dest += 4) {
+            const uint32_t group = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+            dest[0] = kEncodeTable[(group >> 18) & 0x3f];
+            dest[1] = kEncodeTable[(group >> 12) & 0x3f];
+            dest[2] = kEncodeTable[(group >> 6) & 0x3f];
+            dest[3] = kEncodeTable[group & 0x3f];
+        }
+
+        const int rest = size - i;
+        if (rest > 0) {
+            const uint32_t group = (data[i] << 16) | (rest == 2 ? data[i + 1] << 8 : 0);
+            dest[0] = kEncodeTable[(group >> 18) & 0x3f];
+            dest[1] = kEncodeTable[(group >> 12) & 0x3f];
+            dest[2] = rest == 2 ? kEncodeTable[(group >> 6) & 0x3f] : '=';
+            dest[3] = '=';
+        }
     }
-    
+
     int Base64CalcDecodedSize(const Data & str) {
-        const char * p = reinterpret_cast<const char *>(&str[0]);
-        const int len = static_cast<int>(str.size());
-        
+        return Base64CalcDecodedSize(str.data(), static_cast<int>(str.size()));
+    }
+
+    int Base64CalcDecodedSize(const uint8_t * str, int size) {
+        const char * p = reinterpret_cast<const char *>(str);
+        const int len = size;
+
+        //  unpadded input ends with a partial group
+        if (len % 4 != 0) {
+            return len / 4 * 3 + std::max(len % 4 - 1, 0);
+        }
+
         int padding = 0;
         if (2 <= len &&
             p[len-2] == '=' &&
@@ -48,26 +243,69 @@ namespace nwr {
         {
             padding = 1;
         }
-        
+
         return (len * 3) / 4 - padding;
     }
-    
-    void Base64Decode(const Data & str, Data & dest_data) {
-        const int decoded_size = Base64CalcDecodedSize(str);
+
+    bool Base64Decode(const Data & str, Data & dest_data) {
+        return Base64Decode(str.data(), static_cast<int>(str.size()), dest_data);
+    }
+
+    bool Base64Decode(const BufferSlice & str, Data & dest_data) {
+        return Base64Decode(str.ptr(), str.size(), dest_data);
+    }
+
+    bool Base64Decode(const uint8_t * str, int size, Data & dest_data) {
+        if (size % 4 == 1) {
+            return false;
+        }
+        const int decoded_size = Base64CalcDecodedSize(str, size);
         dest_data.resize(decoded_size);
-        
-        const int str_len = static_cast<int>(str.size());
-        BIO * bio = BIO_new_mem_buf(const_cast<uint8_t *>(&str[0]), str_len);
-        
-        BIO * base64 = BIO_new(BIO_f_base64());
-        bio = BIO_push(base64, bio);
-        
-        BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-        int len = BIO_read(bio, &dest_data[0], str_len);
-        if (len != decoded_size) {
-            Fatal(Format("assertion failure: len(%d) == decoded_size(%d)", len, decoded_size));
-        }
-        
-        BIO_free_all(bio);
+        if (size == 0) {
+            return true;
+        }
+        uint8_t * dest = dest_data.data();
+        const uint8_t * values = kDecodeTable.values;
+
+        //  the last group may be padded or partial, so it is left to the tail
+        const int tail_size = size % 4 != 0 ? size % 4 : 4;
+        const int body_size = size - tail_size;
+
+        int i = DecodeBlocks(str, body_size, dest, decoded_size);
+        dest += i / 4 * 3;
+
+        for (; i < body_size; i += 4, dest += 3) {
+            const uint8_t a = values[str[i]];
+            const uint8_t b = values[str[i + 1]];
+            const uint8_t c = values[str[i + 2]];
+            const uint8_t d = values[str[i + 3]];
+            if ((a | b | c | d) == kInvalid) {
+                return false;
+            }
+            const uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+            dest[0] = static_cast<uint8_t>(group >> 16);
+            dest[1] = static_cast<uint8_t>(group >> 8);
+            dest[2] = static_cast<uint8_t>(group);
+        }
+
+        int tail_chars = tail_size;
+        while (tail_size == 4 && tail_chars > 2 && str[i + tail_chars - 1] == '=') {
+            tail_chars -= 1;
+        }
+        uint32_t group = 0;
+        for (int k = 0; k < 4; k++) {
+            uint8_t value = 0;
+            if (k < tail_chars) {
+                value = values[str[i + k]];
+                if (value == kInvalid) {
+                    return false;
+                }
+            }
+            group = (group << 6) | value;
+        }
+        for (int k = 0; k < tail_chars - 1; k++) {
+            dest[k] = static_cast<uint8_t>(group >> (16 - 8 * k));
+        }
+        return true;
     }
-}
\ No newline at end of file
+}
@@ -11,8 +11,17 @@
 #include "data.h"
 
 namespace nwr {
+    //  table driven, with a NEON (arm64) or SSSE3 path for whole blocks
+    int Base64CalcEncodedSize(int size);
     void Base64Encode(const Data & data, Data & dest_str);
+    void Base64Encode(const uint8_t * data, int size, Data & dest_str);
+    void Base64Encode(const BufferSlice & data, Data & dest_str);
+    
+    //  also accepts input without padding
     int Base64CalcDecodedSize(const Data & str);
-    void Base64Decode(const Data & str, Data & dest_data);
+    int Base64CalcDecodedSize(const uint8_t * str, int size);
+    //  returns false on a character out of the alphabet or a broken length
+    bool Base64Decode(const Data & str, Data & dest_data);
+    bool Base64Decode(const uint8_t * str, int size, Data & dest_data);
+    bool Base64Decode(const BufferSlice & str, Data & dest_data);
 }
-
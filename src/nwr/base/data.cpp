@@ -7,15 +7,61 @@
 //
 
 #include "data.h"
+#include "env.h"
 #include "string.h"
 
 namespace nwr {
+    BufferSlice::BufferSlice():
+    offset_(0), size_(0){}
+    
+    BufferSlice::BufferSlice(const DataPtr & backing):
+    BufferSlice(backing, 0, backing ? static_cast<int>(backing->size()) : 0){}
+    
+    BufferSlice::BufferSlice(const DataPtr & backing, int offset, int size):
+    backing_(backing), offset_(offset), size_(size)
+    {
+        const int backing_size = backing ? static_cast<int>(backing->size()) : 0;
+        if (offset < 0 || size < 0 || backing_size < offset + size) {
+            Fatal(Format("invalid slice: offset=%d, size=%d, backing=%d", offset, size, backing_size));
+        }
+    }
+    
+    const uint8_t * BufferSlice::ptr() const {
+        if (!backing_) {
+            return nullptr;
+        }
+        return backing_->data() + offset_;
+    }
+    const char * BufferSlice::char_ptr() const {
+        return reinterpret_cast<const char *>(ptr());
+    }
+    
+    BufferSlice BufferSlice::Slice(int offset) const {
+        return Slice(offset, size_ - offset);
+    }
+    BufferSlice BufferSlice::Slice(int offset, int size) const {
+        if (offset < 0 || size < 0 || size_ < offset + size) {
+            Fatal(Format("invalid slice: offset=%d, size=%d, slice=%d", offset, size, size_));
+        }
+        return BufferSlice(backing_, offset_ + offset, size);
+    }
+    
+    DataPtr BufferSlice::ToDataPtr() const {
+        if (backing_ && offset_ == 0 && size_ == static_cast<int>(backing_->size())) {
+            return backing_;
+        }
+        return std::make_shared<Data>(ptr(), ptr() + size_);
+    }
+    
     const char * AsCharPointer(const Data & data) {
         return reinterpret_cast<const char *>(&data[0]);
     }
     std::string ToString(const Data & data) {
         return std::string(AsCharPointer(data), data.size());
     }
+    std::string ToString(const BufferSlice & slice) {
+        return std::string(slice.char_ptr(), slice.size());
+    }
     
     std::string DataFormat(const Data & data) {
         return DataFormat(&data[0], static_cast<int>(data.size()));
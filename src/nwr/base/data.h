@@ -18,9 +18,39 @@ namespace nwr {
     
     using DataPtr = std::shared_ptr<Data>;
     
+    //  range of a shared Data.
+    //  slicing shares the backing store, so a received frame is not copied
+    //  while it is passed down through the protocol layers.
+    class BufferSlice {
+    public:
+        BufferSlice();
+        BufferSlice(const DataPtr & backing);
+        BufferSlice(const DataPtr & backing, int offset, int size);
+        
+        const DataPtr & backing() const { return backing_; }
+        int offset() const { return offset_; }
+        int size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        
+        const uint8_t * ptr() const;
+        const char * char_ptr() const;
+        uint8_t operator[] (int index) const { return ptr()[index]; }
+        
+        BufferSlice Slice(int offset) const;
+        BufferSlice Slice(int offset, int size) const;
+        
+        //  shares the backing store if this covers it all, copies otherwise
+        DataPtr ToDataPtr() const;
+    private:
+        DataPtr backing_;
+        int offset_;
+        int size_;
+    };
+    
     const char * AsCharPointer(const Data & data);
     
     std::string ToString(const Data & data);
+    std::string ToString(const BufferSlice & slice);
     
     std::string DataFormat(const Data & data);
     std::string DataFormat(const uint8_t * data, int size);
@@ -28,13 +28,22 @@ namespace nwr {
         return std::make_shared<typename EventListener<Event>::element_type>(func);
     }
     
+    //  Emit iterates a snapshot of the listeners without allocation.
+    //  the list is shared with the snapshot during Emit, and copied on write
+    //  only when a listener is added or removed then.
     template <typename Event> class Emitter {
     public:
         Emitter() {}
         ~Emitter() {}
         
         std::vector<EventListener<Event>> listeners() const {
-            return listeners_;
+            std::vector<EventListener<Event>> ret;
+            if (entries_) {
+                for (const auto & entry : *entries_) {
+                    ret.push_back(entry.listener);
+                }
+            }
+            return ret;
         }
         
         void On(const typename EventListener<Event>::element_type & listener) {
@@ -42,44 +51,70 @@ namespace nwr {
         }
         
         void On(const EventListener<Event> & listener) {
-            listeners_.push_back(listener);
+            MutableEntries().push_back(Entry { listener, false });
         }
         
         void Once(const typename EventListener<Event>::element_type & listener) {
             Once(EventListenerMake(listener));
         }
         
+        //  Off with the same listener removes it before it runs
         void Once(const EventListener<Event> & listener) {
-            std::shared_ptr<std::weak_ptr<typename EventListener<Event>::element_type>>
-            weak_on_handler_ptr(new std::weak_ptr<typename EventListener<Event>::element_type>());
-            
-            auto on_handler = EventListenerMake<Event>([this, weak_on_handler_ptr, listener](const Event & event){
-                auto on_handler = (*weak_on_handler_ptr).lock();
-                if (!on_handler) { return; }
-                
-                this->Off(on_handler);
-                (*listener)(event);
-            });
-            
-            *weak_on_handler_ptr = on_handler;
-                        
-            this->On(on_handler);
+            MutableEntries().push_back(Entry { listener, true });
         }
         
         void Off(const EventListener<Event> & listener) {
-            Remove(listeners_, listener);
+            if (!entries_) { return; }
+            RemoveIf(MutableEntries(), [&listener](const Entry & entry) {
+                return entry.listener == listener;
+            });
         }
         void RemoveAllListeners() {
-            listeners_.clear();
+            entries_ = nullptr;
         }
         
         void Emit(const Event & event) {
-            for (auto listener : listeners()) {
-                (*listener)(event);
+            //  holding the list makes a change by a listener copy it
+            auto entries = entries_;
+            if (!entries) { return; }
+            for (const auto & entry : *entries) {
+                if (entry.once && !RemoveOnce(entry.listener)) {
+                    //  already run by a nested Emit, or removed
+                    continue;
+                }
+                (*entry.listener)(event);
             }
         }
     private:
-        std::vector<EventListener<Event>> listeners_;
+        struct Entry {
+            EventListener<Event> listener;
+            bool once;
+        };
+        
+        std::vector<Entry> & MutableEntries() {
+            if (!entries_) {
+                entries_ = std::make_shared<std::vector<Entry>>();
+            } else if (entries_.use_count() > 1) {
+                entries_ = std::make_shared<std::vector<Entry>>(*entries_);
+            }
+            return *entries_;
+        }
+        
+        bool RemoveOnce(const EventListener<Event> & listener) {
+            if (!entries_) { return false; }
+            for (auto iter = entries_->begin(); iter != entries_->end(); iter++) {
+                if (iter->once && iter->listener == listener) {
+                    const auto index = iter - entries_->begin();
+                    auto & entries = MutableEntries();
+                    entries.erase(entries.begin() + index);
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        //  null while no listener was added
+        std::shared_ptr<std::vector<Entry>> entries_;
     };
 }
 
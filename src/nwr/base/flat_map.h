@@ -0,0 +1,162 @@
+//
+//  flat_map.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <initializer_list>
+
+#include "env.h"
+
+namespace nwr {
+    //  ordered map over a sorted vector.
+    //  subset of std::map interface.
+    //  lookup is a binary search over contiguous entries, which is faster
+    //  than std::map for the small objects of signaling messages.
+    //  unlike std::map, insert and erase invalidate iterators and references.
+    //  find accepts any key type comparable with K by == and <.
+    //  small maps are searched linearly with ==, which lets keys like Atom
+    //  compare by identity instead of by string.
+    template <typename K, typename V>
+    class FlatMap {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using size_type = size_t;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+        
+        static constexpr size_type kLinearSearchMax = 8;
+        
+        FlatMap() {}
+        FlatMap(std::initializer_list<value_type> list) {
+            insert(list.begin(), list.end());
+        }
+        template <typename I> FlatMap(I first, I last) {
+            insert(first, last);
+        }
+        
+        iterator begin() { return entries_.begin(); }
+        iterator end() { return entries_.end(); }
+        const_iterator begin() const { return entries_.begin(); }
+        const_iterator end() const { return entries_.end(); }
+        
+        size_type size() const { return entries_.size(); }
+        bool empty() const { return entries_.empty(); }
+        void clear() { entries_.clear(); }
+        void reserve(size_type size) { entries_.reserve(size); }
+        
+        template <typename Q> iterator lower_bound(const Q & key) {
+            return std::lower_bound(entries_.begin(), entries_.end(), key, KeyLess());
+        }
+        template <typename Q> const_iterator lower_bound(const Q & key) const {
+            return std::lower_bound(entries_.begin(), entries_.end(), key, KeyLess());
+        }
+        
+        template <typename Q> iterator find(const Q & key) {
+            return entries_.begin() + FindIndex(key);
+        }
+        template <typename Q> const_iterator find(const Q & key) const {
+            return entries_.begin() + FindIndex(key);
+        }
+        template <typename Q> size_type count(const Q & key) const {
+            return find(key) != end() ? 1 : 0;
+        }
+        
+        V & at(const K & key) {
+            auto iter = find(key);
+            if (iter == end()) {
+                Fatal("FlatMap::at: key not found");
+            }
+            return iter->second;
+        }
+        const V & at(const K & key) const {
+            auto iter = find(key);
+            if (iter == end()) {
+                Fatal("FlatMap::at: key not found");
+            }
+            return iter->second;
+        }
+        
+        V & operator[] (const K & key) {
+            auto iter = lower_bound(key);
+            if (iter == end() || key < iter->first) {
+                iter = entries_.insert(iter, value_type(key, V()));
+            }
+            return iter->second;
+        }
+        V & operator[] (K && key) {
+            auto iter = lower_bound(key);
+            if (iter == end() || key < iter->first) {
+                iter = entries_.insert(iter, value_type(std::move(key), V()));
+            }
+            return iter->second;
+        }
+        
+        std::pair<iterator, bool> insert(const value_type & value) {
+            auto iter = lower_bound(value.first);
+            if (iter != end() && !(value.first < iter->first)) {
+                return std::make_pair(iter, false);
+            }
+            return std::make_pair(entries_.insert(iter, value), true);
+        }
+        std::pair<iterator, bool> insert(value_type && value) {
+            auto iter = lower_bound(value.first);
+            if (iter != end() && !(value.first < iter->first)) {
+                return std::make_pair(iter, false);
+            }
+            return std::make_pair(entries_.insert(iter, std::move(value)), true);
+        }
+        template <typename I> void insert(I first, I last) {
+            for (; first != last; ++first) {
+                insert(value_type(first->first, first->second));
+            }
+        }
+        
+        iterator erase(const_iterator iter) {
+            return entries_.erase(iter);
+        }
+        size_type erase(const K & key) {
+            auto iter = find(key);
+            if (iter == end()) {
+                return 0;
+            }
+            entries_.erase(iter);
+            return 1;
+        }
+    private:
+        struct KeyLess {
+            template <typename Q>
+            bool operator() (const value_type & entry, const Q & key) const {
+                return entry.first < key;
+            }
+        };
+        
+        //  index of the entry, or size() if not found
+        template <typename Q> size_type FindIndex(const Q & key) const {
+            if (entries_.size() <= kLinearSearchMax) {
+                for (size_type i = 0; i < entries_.size(); i++) {
+                    if (entries_[i].first == key) {
+                        return i;
+                    }
+                }
+                return entries_.size();
+            }
+            auto iter = lower_bound(key);
+            if (iter != end() && iter->first == key) {
+                return iter - entries_.begin();
+            }
+            return entries_.size();
+        }
+        
+        std::vector<value_type> entries_;
+    };
+}
@@ -12,6 +12,7 @@
 #include <string>
 #include <map>
 #include <nwr/base/data.h>
+#include <nwr/base/promise.h>
 
 namespace nwr {
     class HttpOperationImpl;
@@ -35,6 +36,8 @@ namespace nwr {
     class HttpOperation : public std::enable_shared_from_this<HttpOperation> {
     public:
         static std::shared_ptr<HttpOperation> Create(const HttpRequest & request);
+        //  starts an operation settled by its success or failure
+        static PromisePtr<HttpResponse> Fetch(const HttpRequest & request);
         
         void set_on_success(const std::function<void(const HttpResponse &)> & value);
         void set_on_failure(const std::function<void(const std::string &)> & value);
@@ -28,6 +28,18 @@ namespace nwr {
         thiz->impl_->Start(request);
         return thiz;
     }
+    PromisePtr<HttpResponse> HttpOperation::Fetch(const HttpRequest & request)
+    {
+        auto promise = Promise<HttpResponse>::Create();
+        auto op = Create(request);
+        op->set_on_success([promise](const HttpResponse & response) {
+            promise->Resolve(response);
+        });
+        op->set_on_failure([promise](const std::string & error) {
+            promise->Reject(error);
+        });
+        return promise;
+    }
     void HttpOperation::set_on_success(const std::function<void(const HttpResponse &)> & value)
     {
         impl_->on_success_ = value;
@@ -17,7 +17,7 @@ namespace nwr {
     public:
         IosLooper();
         virtual ~IosLooper() {}
-        virtual void PostTask(const Task & task);
+        virtual void PostTask(Task && task);
         virtual void Quit();
     private:
         NSOperationQueue * operation_queue_;
@@ -8,14 +8,18 @@
 
 #include "ios_looper.h"
 
+#include "task_instrument.h"
+
 namespace nwr {
     IosLooper::IosLooper() {
         operation_queue_ = [[NSOperationQueue alloc] init];
     }
-    void IosLooper::PostTask(const Task & task) {
-        Task task_copy = task;
+    void IosLooper::PostTask(Task && task) {
+        //  a block copies its captures, so the move only task goes by pointer
+        Task * task_ptr = new Task(TaskInstrument::shared().Wrap("IosLooper", std::move(task)));
         [operation_queue_ addOperationWithBlock:^{
-            task_copy();
+            (*task_ptr)();
+            delete task_ptr;
         }];
     }
     void IosLooper::Quit() {
@@ -25,7 +25,7 @@ namespace nwr {
         
         NSOperationQueue * inner_queue() { return operation_queue_; }
         
-        void PostTask(const Task & task) override;
+        void PostTask(Task && task) override;
         static std::shared_ptr<IosTaskQueue> current_queue();
     private:
         NSOperationQueue * operation_queue_;
@@ -8,6 +8,8 @@
 
 #include "ios_task_queue.h"
 
+#include "task_instrument.h"
+
 namespace nwr {
     IosTaskQueue::~IosTaskQueue() {
         std::lock_guard<std::mutex> lk(cache_mutex_);
@@ -17,10 +19,12 @@ namespace nwr {
     IosTaskQueue::IosTaskQueue(NSOperationQueue * operation_queue):
     operation_queue_(operation_queue){
     }
-    void IosTaskQueue::PostTask(const Task & task) {
-        Task task_copy = task;
+    void IosTaskQueue::PostTask(Task && task) {
+        //  a block copies its captures, so the move only task goes by pointer
+        Task * task_ptr = new Task(TaskInstrument::shared().Wrap("IosTaskQueue", std::move(task)));
         [operation_queue_ addOperationWithBlock:^{
-            task_copy();
+            (*task_ptr)();
+            delete task_ptr;
         }];
     }
     std::shared_ptr<IosTaskQueue> IosTaskQueue::current_queue() {
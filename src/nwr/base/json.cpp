@@ -8,6 +8,15 @@
 
 #include "json.h"
 
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "any.h"
+#include "string.h"
+
 namespace nwr {
     std::shared_ptr<Json::Value> JsonParse(const std::string & str) {
         return JsonParse(reinterpret_cast<const uint8_t *>(&str[0]),
@@ -28,4 +37,591 @@ namespace nwr {
     std::string JsonFormat(const Json::Value & json) {
         return rtc::JsonValueToString(json);
     }
-}
\ No newline at end of file
+    
+    //  same limit as Json::Reader
+    static const int kJsonMaxDepth = 1000;
+    
+    JsonParseError::JsonParseError():
+    position(-1)
+    {}
+    
+    JsonReader::JsonReader(const uint8_t * data, int size):
+    begin_(data),
+    end_(data + size),
+    p_(data)
+    {}
+    
+    bool JsonReader::Parse(JsonHandler & handler) {
+        p_ = begin_;
+        error_ = JsonParseError();
+        
+        SkipSpace();
+        if (!ParseValue(handler, 0)) {
+            return false;
+        }
+        SkipSpace();
+        if (p_ != end_) {
+            return SetError("extra data after value");
+        }
+        return true;
+    }
+    
+    bool JsonReader::ParseValue(JsonHandler & handler, int depth) {
+        if (p_ == end_) {
+            return SetError("unexpected end of input");
+        }
+        switch (*p_) {
+            case '{':
+                return ParseObject(handler, depth + 1);
+            case '[':
+                return ParseArray(handler, depth + 1);
+            case '"': {
+                const char * chars;
+                int size;
+                if (!ParseString(&chars, &size)) { return false; }
+                handler.OnString(chars, size);
+                return true;
+            }
+            case 't':
+                if (!ParseLiteral("true")) { return false; }
+                handler.OnBoolean(true);
+                return true;
+            case 'f':
+                if (!ParseLiteral("false")) { return false; }
+                handler.OnBoolean(false);
+                return true;
+            case 'n':
+                if (!ParseLiteral("null")) { return false; }
+                handler.OnNull();
+                return true;
+            default: {
+                double value;
+                if (!ParseNumber(&value)) { return false; }
+                handler.OnNumber(value);
+                return true;
+            }
+        }
+    }
+    
+    bool JsonReader::ParseArray(JsonHandler & handler, int depth) {
+        if (depth > kJsonMaxDepth) {
+            return SetError("nesting too deep");
+        }
+        p_ += 1;
+        handler.OnArrayBegin();
+        
+        SkipSpace();
+        if (p_ != end_ && *p_ == ']') {
+            p_ += 1;
+            handler.OnArrayEnd();
+            return true;
+        }
+        
+        while (true) {
+            SkipSpace();
+            if (!ParseValue(handler, depth)) { return false; }
+            SkipSpace();
+            if (p_ == end_) {
+                return SetError("unexpected end of input in array");
+            }
+            if (*p_ == ',') {
+                p_ += 1;
+                continue;
+            }
+            if (*p_ == ']') {
+                p_ += 1;
+                handler.OnArrayEnd();
+                return true;
+            }
+            return SetError("expected ',' or ']'");
+        }
+    }
+    
+    bool JsonReader::ParseObject(JsonHandler & handler, int depth) {
+        if (depth > kJsonMaxDepth) {
+            return SetError("nesting too deep");
+        }
+        p_ += 1;
+        handler.OnObjectBegin();
+        
+        SkipSpace();
+        if (p_ != end_ && *p_ == '}') {
+            p_ += 1;
+            handler.OnObjectEnd();
+            return true;
+        }
+        
+        while (true) {
+            SkipSpace();
+            if (p_ == end_ || *p_ != '"') {
+                return SetError("expected object key");
+            }
+            const char * key;
+            int key_size;
+            if (!ParseString(&key, &key_size)) { return false; }
+            handler.OnObjectKey(key, key_size);
+            
+            SkipSpace();
+            if (p_ == end_ || *p_ != ':') {
+                return SetError("expected ':'");
+            }
+            p_ += 1;
+            SkipSpace();
+            if (!ParseValue(handler, depth)) { return false; }
+            
+            SkipSpace();
+            if (p_ == end_) {
+                return SetError("unexpected end of input in object");
+            }
+            if (*p_ == ',') {
+                p_ += 1;
+                continue;
+            }
+            if (*p_ == '}') {
+                p_ += 1;
+                handler.OnObjectEnd();
+                return true;
+            }
+            return SetError("expected ',' or '}'");
+        }
+    }
+    
+    bool JsonReader::ParseString(const char ** chars, int * size) {
+        p_ += 1;
+        const uint8_t * start = p_;
+        
+        //  fast path: no escape, point into the input.
+        //  raw control characters are accepted like Json::Reader does.
+        while (p_ != end_ && *p_ != '"' && *p_ != '\\') {
+            p_ += 1;
+        }
+        if (p_ == end_) {
+            return SetError("unterminated string");
+        }
+        if (*p_ == '"') {
+            *chars = reinterpret_cast<const char *>(start);
+            *size = static_cast<int>(p_ - start);
+            p_ += 1;
+            return true;
+        }
+        
+        string_buffer_.assign(reinterpret_cast<const char *>(start), p_ - start);
+        
+        while (true) {
+            if (p_ == end_) {
+                return SetError("unterminated string");
+            }
+            uint8_t c = *p_;
+            if (c == '"') {
+                p_ += 1;
+                break;
+            }
+            if (c != '\\') {
+                string_buffer_ += static_cast<char>(c);
+                p_ += 1;
+                continue;
+            }
+            
+            p_ += 1;
+            if (p_ == end_) {
+                return SetError("unterminated string");
+            }
+            c = *p_;
+            p_ += 1;
+            switch (c) {
+                case '"': string_buffer_ += '"'; break;
+                case '\\': string_buffer_ += '\\'; break;
+                case '/': string_buffer_ += '/'; break;
+                case 'b': string_buffer_ += '\b'; break;
+                case 'f': string_buffer_ += '\f'; break;
+                case 'n': string_buffer_ += '\n'; break;
+                case 'r': string_buffer_ += '\r'; break;
+                case 't': string_buffer_ += '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!ParseHex4(&code)) { return false; }
+                    if (0xD800 <= code && code <= 0xDBFF) {
+                        uint32_t low;
+                        if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                            return SetError("missing low surrogate");
+                        }
+                        p_ += 2;
+                        if (!ParseHex4(&low)) { return false; }
+                        if (!(0xDC00 <= low && low <= 0xDFFF)) {
+                            return SetError("invalid low surrogate");
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    if (code < 0x80) {
+                        string_buffer_ += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        string_buffer_ += static_cast<char>(0xC0 | (code >> 6));
+                        string_buffer_ += static_cast<char>(0x80 | (code & 0x3F));
+                    } else if (code < 0x10000) {
+                        string_buffer_ += static_cast<char>(0xE0 | (code >> 12));
+                        string_buffer_ += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        string_buffer_ += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        string_buffer_ += static_cast<char>(0xF0 | (code >> 18));
+                        string_buffer_ += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                        string_buffer_ += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        string_buffer_ += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default:
+                    p_ -= 1;
+                    return SetError("invalid escape");
+            }
+        }
+        
+        *chars = string_buffer_.c_str();
+        *size = static_cast<int>(string_buffer_.length());
+        return true;
+    }
+    
+    bool JsonReader::ParseNumber(double * value) {
+        const uint8_t * start = p_;
+        bool negative = false;
+        bool is_integer = true;
+        int int_digits = 0;
+        int64_t int_value = 0;
+        
+        if (p_ != end_ && *p_ == '-') {
+            negative = true;
+            p_ += 1;
+        }
+        if (p_ == end_ || !isdigit(*p_)) {
+            p_ = start;
+            return SetError("invalid value");
+        }
+        if (*p_ == '0') {
+            p_ += 1;
+            int_digits = 1;
+        } else {
+            while (p_ != end_ && isdigit(*p_)) {
+                if (int_digits < 18) {
+                    int_value = int_value * 10 + (*p_ - '0');
+                }
+                int_digits += 1;
+                p_ += 1;
+            }
+        }
+        if (p_ != end_ && *p_ == '.') {
+            is_integer = false;
+            p_ += 1;
+            if (p_ == end_ || !isdigit(*p_)) {
+                return SetError("invalid number");
+            }
+            while (p_ != end_ && isdigit(*p_)) { p_ += 1; }
+        }
+        if (p_ != end_ && (*p_ == 'e' || *p_ == 'E')) {
+            is_integer = false;
+            p_ += 1;
+            if (p_ != end_ && (*p_ == '+' || *p_ == '-')) { p_ += 1; }
+            if (p_ == end_ || !isdigit(*p_)) {
+                return SetError("invalid number");
+            }
+            while (p_ != end_ && isdigit(*p_)) { p_ += 1; }
+        }
+        
+        //  integers up to 15 digits are exact in double
+        if (is_integer && int_digits <= 15) {
+            *value = static_cast<double>(int_value);
+            if (negative) { *value = -*value; }
+            return true;
+        }
+        
+        //  input is not null terminated
+        char stack_buf[64];
+        const int len = static_cast<int>(p_ - start);
+        std::string heap_buf;
+        char * buf = stack_buf;
+        if (len >= static_cast<int>(sizeof(stack_buf))) {
+            heap_buf.resize(len + 1);
+            buf = &heap_buf[0];
+        }
+        memcpy(buf, start, len);
+        buf[len] = '\0';
+        *value = strtod(buf, nullptr);
+        return true;
+    }
+    
+    bool JsonReader::ParseLiteral(const char * literal) {
+        const int len = static_cast<int>(strlen(literal));
+        if (end_ - p_ < len || memcmp(p_, literal, len) != 0) {
+            return SetError("invalid value");
+        }
+        p_ += len;
+        return true;
+    }
+    
+    bool JsonReader::ParseHex4(uint32_t * value) {
+        if (end_ - p_ < 4) {
+            return SetError("invalid unicode escape");
+        }
+        uint32_t code = 0;
+        for (int i = 0; i < 4; i++) {
+            const uint8_t c = p_[i];
+            code <<= 4;
+            if ('0' <= c && c <= '9') {
+                code |= c - '0';
+            } else if ('a' <= c && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if ('A' <= c && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                p_ += i;
+                return SetError("invalid unicode escape");
+            }
+        }
+        p_ += 4;
+        *value = code;
+        return true;
+    }
+    
+    void JsonReader::SkipSpace() {
+        while (p_ != end_ &&
+               (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r'))
+        {
+            p_ += 1;
+        }
+    }
+    
+    bool JsonReader::SetError(const std::string & message) {
+        error_.position = static_cast<int>(p_ - begin_);
+        error_.message = message;
+        return false;
+    }
+    
+    //  builds Any tree directly from reader tokens
+    class AnyJsonHandler: public JsonHandler {
+    public:
+        void OnNull() override { Put(Any()); }
+        void OnBoolean(bool value) override { Put(Any(value)); }
+        void OnNumber(double value) override { Put(Any(value)); }
+        void OnString(const char * chars, int size) override {
+            Put(Any(std::string(chars, size)));
+        }
+        void OnArrayBegin() override {
+            stack_.push_back(Frame());
+            stack_.back().is_array = true;
+        }
+        void OnArrayEnd() override {
+            Any value(std::move(stack_.back().array));
+            stack_.pop_back();
+            Put(std::move(value));
+        }
+        void OnObjectBegin() override {
+            stack_.push_back(Frame());
+            stack_.back().is_array = false;
+        }
+        void OnObjectKey(const char * chars, int size) override {
+            stack_.back().key.assign(chars, size);
+        }
+        void OnObjectEnd() override {
+            Any value(std::move(stack_.back().object));
+            stack_.pop_back();
+            Put(std::move(value));
+        }
+        
+        Any & result() { return result_; }
+    private:
+        struct Frame {
+            bool is_array;
+            Any::ArrayType array;
+            Any::ObjectType object;
+            std::string key;
+        };
+        
+        void Put(Any && value) {
+            if (stack_.size() == 0) {
+                result_ = std::move(value);
+                return;
+            }
+            auto & frame = stack_.back();
+            if (frame.is_array) {
+                frame.array.push_back(std::move(value));
+            } else {
+                frame.object[Atom(frame.key)] = std::move(value);
+            }
+        }
+        
+        std::vector<Frame> stack_;
+        Any result_;
+    };
+    
+    bool JsonParseAny(const uint8_t * data, int size, Any & dest) {
+        return JsonParseAny(data, size, dest, nullptr);
+    }
+    bool JsonParseAny(const uint8_t * data, int size, Any & dest, JsonParseError * error) {
+        JsonReader reader(data, size);
+        AnyJsonHandler handler;
+        if (!reader.Parse(handler)) {
+            if (error) {
+                *error = reader.error();
+            }
+            return false;
+        }
+        dest = std::move(handler.result());
+        return true;
+    }
+    
+    template <typename Buffer>
+    class JsonAnyWriter {
+    public:
+        explicit JsonAnyWriter(Buffer & buffer):
+        buffer_(buffer)
+        {}
+        
+        void Write(const Any & value) {
+            switch (value.type()) {
+                case Any::Type::Null:
+                    Append("null", 4);
+                    return;
+                case Any::Type::Boolean:
+                    if (value.boolean_) {
+                        Append("true", 4);
+                    } else {
+                        Append("false", 5);
+                    }
+                    return;
+                case Any::Type::Number:
+                    WriteNumber(value.number_);
+                    return;
+                case Any::Type::String:
+                    WriteString(value.string_chars(), value.string_size());
+                    return;
+                case Any::Type::Data:
+                    WriteString(Format("<Data %s>", DataFormat(**value.AsData()).c_str()));
+                    return;
+                case Any::Type::Array: {
+                    auto & array = *value.inner_array();
+                    Append('[');
+                    for (size_t i = 0; i < array.size(); i++) {
+                        if (i > 0) { Append(','); }
+                        Write(array[i]);
+                    }
+                    Append(']');
+                    return;
+                }
+                case Any::Type::Object: {
+                    auto & object = *value.inner_object();
+                    Append('{');
+                    bool first = true;
+                    for (auto & entry : object) {
+                        if (!first) { Append(','); }
+                        first = false;
+                        WriteString(entry.first.str());
+                        Append(':');
+                        Write(entry.second);
+                    }
+                    Append('}');
+                    return;
+                }
+                case Any::Type::Function:
+                    WriteString(Format("<Function %p>", value.value_.get()));
+                    return;
+                case Any::Type::Pointer:
+                    WriteString(Format("<Pointer %p>", value.value_.get()));
+                    return;
+            }
+        }
+    private:
+        void Append(char c) {
+            buffer_.push_back(static_cast<typename Buffer::value_type>(c));
+        }
+        void Append(const char * chars, int size) {
+            buffer_.insert(buffer_.end(), chars, chars + size);
+        }
+        
+        void WriteNumber(double value) {
+            if (!std::isfinite(value)) {
+                //  same as JSON.stringify
+                Append("null", 4);
+                return;
+            }
+            
+            char buf[32];
+            
+            //  integers within the exact range of double
+            if (std::abs(value) < 9007199254740992.0 && value == std::floor(value)) {
+                int64_t n = static_cast<int64_t>(value);
+                uint64_t u = n < 0 ? static_cast<uint64_t>(-n) : static_cast<uint64_t>(n);
+                char * q = buf + sizeof(buf);
+                do {
+                    q -= 1;
+                    *q = static_cast<char>('0' + u % 10);
+                    u /= 10;
+                } while (u != 0);
+                if (n < 0) {
+                    q -= 1;
+                    *q = '-';
+                }
+                Append(q, static_cast<int>(buf + sizeof(buf) - q));
+                return;
+            }
+            
+            //  shortest precision that round trips
+            int size = 0;
+            for (int precision = 15; precision <= 17; precision++) {
+                size = snprintf(buf, sizeof(buf), "%.*g", precision, value);
+                if (precision == 17 || strtod(buf, nullptr) == value) {
+                    break;
+                }
+            }
+            Append(buf, size);
+        }
+        
+        void WriteString(const std::string & str) {
+            WriteString(str.c_str(), static_cast<int>(str.length()));
+        }
+        void WriteString(const char * chars, int size) {
+            static const char * hex = "0123456789abcdef";
+            
+            Append('"');
+            const char * end = chars + size;
+            const char * run = chars;
+            for (const char * p = chars; p != end; p++) {
+                uint8_t c = static_cast<uint8_t>(*p);
+                //  plain characters are copied in runs
+                if (c >= 0x20 && c != '"' && c != '\\') {
+                    continue;
+                }
+                Append(run, static_cast<int>(p - run));
+                run = p + 1;
+                
+                switch (c) {
+                    case '"': Append("\\\"", 2); break;
+                    case '\\': Append("\\\\", 2); break;
+                    case '\b': Append("\\b", 2); break;
+                    case '\f': Append("\\f", 2); break;
+                    case '\n': Append("\\n", 2); break;
+                    case '\r': Append("\\r", 2); break;
+                    case '\t': Append("\\t", 2); break;
+                    default: {
+                        char u[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                        Append(u, 6);
+                        break;
+                    }
+                }
+            }
+            Append(run, static_cast<int>(end - run));
+            Append('"');
+        }
+        
+        Buffer & buffer_;
+    };
+    
+    void JsonAppendAny(std::string & dest, const Any & value) {
+        JsonAnyWriter<std::string>(dest).Write(value);
+    }
+    void JsonAppendAny(Data & dest, const Any & value) {
+        JsonAnyWriter<Data>(dest).Write(value);
+    }
+    std::string JsonFormatAny(const Any & value) {
+        std::string ret;
+        JsonAppendAny(ret, value);
+        return ret;
+    }
+}
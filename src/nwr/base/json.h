@@ -9,6 +9,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <webrtc/base/json.h>
 
@@ -16,8 +18,68 @@
 #include "optional.h"
 
 namespace nwr {
+    class Any;
+    
     std::shared_ptr<Json::Value> JsonParse(const std::string & str);
     std::shared_ptr<Json::Value> JsonParse(const Data & data);
     std::shared_ptr<Json::Value> JsonParse(const uint8_t * data, int size);
     std::string JsonFormat(const Json::Value & json);
+    
+    struct JsonParseError {
+        JsonParseError();
+        
+        //  byte offset in the input
+        int position;
+        std::string message;
+    };
+    
+    //  receives tokens from JsonReader in document order.
+    //  strings are passed unescaped, valid only during the call.
+    class JsonHandler {
+    public:
+        virtual ~JsonHandler() {}
+        virtual void OnNull() = 0;
+        virtual void OnBoolean(bool value) = 0;
+        virtual void OnNumber(double value) = 0;
+        virtual void OnString(const char * chars, int size) = 0;
+        virtual void OnArrayBegin() = 0;
+        virtual void OnArrayEnd() = 0;
+        virtual void OnObjectBegin() = 0;
+        virtual void OnObjectKey(const char * chars, int size) = 0;
+        virtual void OnObjectEnd() = 0;
+    };
+    
+    //  single pass parser without intermediate tree
+    class JsonReader {
+    public:
+        JsonReader(const uint8_t * data, int size);
+        
+        bool Parse(JsonHandler & handler);
+        const JsonParseError & error() const { return error_; }
+    private:
+        bool ParseValue(JsonHandler & handler, int depth);
+        bool ParseArray(JsonHandler & handler, int depth);
+        bool ParseObject(JsonHandler & handler, int depth);
+        bool ParseString(const char ** chars, int * size);
+        bool ParseNumber(double * value);
+        bool ParseLiteral(const char * literal);
+        bool ParseHex4(uint32_t * value);
+        void SkipSpace();
+        bool SetError(const std::string & message);
+        
+        const uint8_t * begin_;
+        const uint8_t * end_;
+        const uint8_t * p_;
+        std::string string_buffer_;
+        JsonParseError error_;
+    };
+    
+    bool JsonParseAny(const uint8_t * data, int size, Any & dest);
+    bool JsonParseAny(const uint8_t * data, int size, Any & dest, JsonParseError * error);
+    
+    //  appends compact JSON of value to the end of dest.
+    //  numbers are written in the shortest form that reads back to the same double.
+    void JsonAppendAny(std::string & dest, const Any & value);
+    void JsonAppendAny(Data & dest, const Any & value);
+    std::string JsonFormatAny(const Any & value);
 }
@@ -0,0 +1,193 @@
+//
+//  linux_looper.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "linux_looper.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+
+#include <errno.h>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "env.h"
+#include "string.h"
+#include "task_instrument.h"
+#include "virtual_time_queue.h"
+
+namespace nwr {
+    namespace {
+        thread_local LinuxLooper * current_looper = nullptr;
+
+        void AddToEpoll(int epoll_fd, int fd) {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+                Fatal(Format("epoll_ctl failed: %s", strerror(errno)));
+            }
+        }
+
+        void DrainFd(int fd) {
+            uint64_t count;
+            while (read(fd, &count, sizeof(count)) == sizeof(count)) {}
+        }
+    }
+
+    LinuxLooper::LinuxLooper():
+    wakeup_pending_(false),
+    quit_(false)
+    {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (epoll_fd_ == -1 || event_fd_ == -1 || timer_fd_ == -1) {
+            Fatal(Format("LinuxLooper init failed: %s", strerror(errno)));
+        }
+        AddToEpoll(epoll_fd_, event_fd_);
+        AddToEpoll(epoll_fd_, timer_fd_);
+        //  the loop rearms the timerfd after it wakes
+        timer_service_ = std::make_shared<TimerService>([this]{
+            Wakeup();
+        });
+    }
+
+    LinuxLooper::~LinuxLooper() {
+        //  a Timer may keep the service after this
+        timer_service_->ClearWakeup();
+        if (thread_.joinable()) {
+            //  the last owner may be the task running on the thread
+            if (thread_.get_id() == std::this_thread::get_id()) {
+                thread_.detach();
+            } else {
+                thread_.join();
+            }
+        }
+        close(timer_fd_);
+        close(event_fd_);
+        close(epoll_fd_);
+    }
+
+    void LinuxLooper::PostTask(Task && task) {
+        tasks_.Push(TaskInstrument::shared().Wrap("LinuxLooper", std::move(task)));
+        Wakeup();
+    }
+
+    void LinuxLooper::PostDelayedTask(const TimeDuration & delay, Task && task) {
+        timer_service_->Schedule(Clock::now() + std::chrono::duration_cast<Clock::duration>(delay),
+                                 std::move(task));
+    }
+
+    void LinuxLooper::Run() {
+        LinuxLooper * outer = current_looper;
+        current_looper = this;
+
+        epoll_event events[2];
+        while (!quit_) {
+            const int count = epoll_wait(epoll_fd_, events, 2, -1);
+            if (count == -1) {
+                if (errno == EINTR) { continue; }
+                Fatal(Format("epoll_wait failed: %s", strerror(errno)));
+            }
+            for (int i = 0; i < count; i++) {
+                DrainFd(events[i].data.fd);
+            }
+
+            //  cleared before draining, so a task posted after it writes again
+            wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+            RunTasks();
+            RunTimers();
+        }
+
+        current_looper = outer;
+    }
+
+    void LinuxLooper::Start() {
+        auto thiz = std::static_pointer_cast<LinuxLooper>(shared_from_this());
+        thread_ = std::thread([thiz]{
+            thiz->Run();
+        });
+    }
+
+    void LinuxLooper::Quit() {
+        PostTask([this]{
+            quit_ = true;
+        });
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+    }
+
+    LinuxLooper * LinuxLooper::current() {
+        return current_looper;
+    }
+
+    void LinuxLooper::Wakeup() {
+        //  one eventfd write until the loop wakes
+        if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+            const uint64_t one = 1;
+            if (write(event_fd_, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+                Fatal(Format("eventfd write failed: %s", strerror(errno)));
+            }
+        }
+    }
+
+    void LinuxLooper::RunTasks() {
+        Task task;
+        while (!quit_ && tasks_.Pop(task)) {
+            task();
+            task = nullptr;
+        }
+    }
+
+    void LinuxLooper::RunTimers() {
+        if (quit_) { return; }
+        timer_service_->AdvanceTo(Clock::now());
+        ArmTimer();
+    }
+
+    void LinuxLooper::ArmTimer() {
+        itimerspec spec = { { 0, 0 }, { 0, 0 } };
+        Clock::time_point deadline;
+        if (timer_service_->next_deadline(deadline)) {
+            //  steady_clock is CLOCK_MONOTONIC on Linux
+            const auto since_epoch = std::max(deadline.time_since_epoch(), Clock::duration(1));
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+            spec.it_value.tv_sec = seconds.count();
+            spec.it_value.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (since_epoch - seconds).count();
+        }
+        //  a zero it_value disarms
+        if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) == -1) {
+            Fatal(Format("timerfd_settime failed: %s", strerror(errno)));
+        }
+    }
+
+    std::shared_ptr<Looper> Looper::Create() {
+        auto looper = std::make_shared<LinuxLooper>();
+        looper->Start();
+        return looper;
+    }
+
+    std::shared_ptr<TaskQueue> TaskQueue::current_queue() {
+        if (VirtualTimeQueue * queue = VirtualTimeQueue::current()) {
+            return queue->shared_from_this();
+        }
+        LinuxLooper * looper = LinuxLooper::current();
+        if (!looper) {
+            Fatal("no LinuxLooper runs on this thread");
+        }
+        return looper->shared_from_this();
+    }
+}
+
+#endif
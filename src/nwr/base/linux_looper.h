@@ -0,0 +1,74 @@
+//
+//  linux_looper.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "looper.h"
+#include "mpsc_queue.h"
+#include "time.h"
+#include "timer_service.h"
+
+namespace nwr {
+    //  Looper and TaskQueue of Linux, in place of IosLooper and IosTaskQueue.
+    //  an epoll loop wakes on an eventfd for posted tasks
+    //  and on a timerfd armed at the earliest deadline of its TimerService,
+    //  so Timer, TimerPool and Sleep on this looper run on the loop thread without a timer thread.
+    //  while Run is on a thread, TaskQueue::current_queue() there is this looper.
+    class LinuxLooper: public Looper {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        LinuxLooper();
+        virtual ~LinuxLooper();
+
+        void PostTask(Task && task) override;
+        //  on the timer service, so it runs on the loop thread
+        void PostDelayedTask(const TimeDuration & delay, Task && task);
+        std::shared_ptr<TimerService> timer_service() override { return timer_service_; }
+
+        //  runs the loop on the calling thread until Quit
+        void Run();
+        //  runs the loop on a new thread, which keeps this alive until Quit
+        void Start();
+        //  the loop ends after the tasks posted before; joins a started thread
+        void Quit() override;
+
+        //  the looper running on this thread, or null
+        static LinuxLooper * current();
+    private:
+        //  from any thread
+        void Wakeup();
+        void RunTasks();
+        void RunTimers();
+        void ArmTimer();
+
+        int epoll_fd_;
+        int event_fd_;
+        int timer_fd_;
+
+        MpscQueue<Task> tasks_;
+        std::atomic<bool> wakeup_pending_;
+
+        //  driven by the loop
+        std::shared_ptr<TimerService> timer_service_;
+
+        //  loop thread only
+        bool quit_;
+
+        std::thread thread_;
+    };
+}
+
+#endif
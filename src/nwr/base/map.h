@@ -12,6 +12,8 @@
 #include <map>
 #include <functional>
 
+#include "flat_map.h"
+
 namespace nwr {
     
     template <typename K, typename V>
@@ -42,4 +44,34 @@ namespace nwr {
         std::vector<std::pair<K, V>> pairs = Map(map, mapf);
         return std::map<K, V>(pairs.begin(), pairs.end());
     }
+    
+    template <typename K, typename V>
+    bool HasKey(const FlatMap<K, V> & map, const typename FlatMap<K, V>::key_type & key) {
+        return map.find(key) != map.end();
+    }
+    
+    template <typename K, typename V>
+    std::vector<K> Keys(const FlatMap<K, V> & map) {
+        std::vector<K> r;
+        r.reserve(map.size());
+        for (const auto & pair : map) {
+            r.push_back(pair.first);
+        }
+        return r;
+    }
+    
+    template <typename K, typename V, typename F>
+    std::vector<std::pair<K, V>> Map(const FlatMap<K, V> & map, const F & mapf) {
+        std::vector<std::pair<K, V>> r;
+        for (const auto & pair : map) {
+            r.push_back(mapf(pair.first, pair.second));
+        }
+        return r;
+    }
+    
+    template <typename K, typename V, typename F>
+    FlatMap<K, V> MapToMap(const FlatMap<K, V> & map, const F & mapf) {
+        std::vector<std::pair<K, V>> pairs = Map(map, mapf);
+        return FlatMap<K, V>(pairs.begin(), pairs.end());
+    }
 }
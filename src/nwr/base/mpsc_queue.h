@@ -0,0 +1,72 @@
+//
+//  mpsc_queue.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+namespace nwr {
+    //  lock free queue of many producers and one consumer.
+    //  Push is one atomic exchange, Pop is called only from the consumer thread.
+    template <typename T>
+    class MpscQueue {
+    public:
+        MpscQueue():
+        head_(new Node()),
+        tail_(head_.load())
+        {}
+
+        ~MpscQueue() {
+            T value;
+            while (Pop(value)) {}
+            delete tail_;
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue & operator= (const MpscQueue &) = delete;
+
+        void Push(T value) {
+            Node * node = new Node(std::move(value));
+            Node * prev = head_.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        //  consumer thread only
+        bool Pop(T & dest) {
+            Node * tail = tail_;
+            Node * next = tail->next.load(std::memory_order_acquire);
+            if (!next) {
+                if (head_.load(std::memory_order_acquire) == tail) {
+                    return false;
+                }
+                //  a producer is between its exchange and link
+                while (!(next = tail->next.load(std::memory_order_acquire))) {
+                    std::this_thread::yield();
+                }
+            }
+            dest = std::move(next->value);
+            //  next becomes the empty head node
+            tail_ = next;
+            delete tail;
+            return true;
+        }
+    private:
+        struct Node {
+            std::atomic<Node *> next;
+            T value;
+
+            Node(): next(nullptr) {}
+            explicit Node(T && value): next(nullptr), value(std::move(value)) {}
+        };
+
+        std::atomic<Node *> head_;
+        Node * tail_;
+    };
+}
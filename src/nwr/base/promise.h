@@ -0,0 +1,195 @@
+//
+//  promise.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "none.h"
+#include "task_queue.h"
+
+namespace nwr {
+    template <typename T> class Promise;
+    template <typename T> using PromisePtr = std::shared_ptr<Promise<T>>;
+    
+    template <typename R> struct PromiseChain;
+    
+    //  a value or an error coming later, in the way of the JavaScript Promise.
+    //  Resolve and Reject may be called on any thread, and the first one wins.
+    //  a continuation runs on the queue it was attached on,
+    //  so a chain of Then reads in order and keeps running on its owner.
+    //
+    //  the result of a Then continuation decides the next promise:
+    //  void resolves it with None, a value resolves it with the value,
+    //  and a PromisePtr is waited for, so an async step does not nest.
+    //  a null PromisePtr stops the chain there, as a cancelled step.
+    template <typename T>
+    class Promise: public std::enable_shared_from_this<Promise<T>> {
+    public:
+        using ValueType = T;
+        
+        static PromisePtr<T> Create() {
+            return std::make_shared<Promise<T>>();
+        }
+        static PromisePtr<T> Resolved(const T & value) {
+            auto promise = Create();
+            promise->Resolve(value);
+            return promise;
+        }
+        static PromisePtr<T> Rejected(const std::string & error) {
+            auto promise = Create();
+            promise->Reject(error);
+            return promise;
+        }
+        
+        Promise(): settled_(false) {}
+        Promise(const Promise &) = delete;
+        Promise & operator= (const Promise &) = delete;
+        
+        void Resolve(const T & value) {
+            Settle(std::unique_ptr<T>(new T(value)), std::string());
+        }
+        void Reject(const std::string & error) {
+            Settle(nullptr, error);
+        }
+        
+        //  on_value takes const T &, and runs on the current queue
+        template <typename F>
+        PromisePtr<typename PromiseChain<typename std::result_of<F(const T &)>::type>::ValueType>
+        Then(const F & on_value) {
+            return Then(TaskQueue::current_queue(), on_value);
+        }
+        
+        //  on_value runs on queue, or on the settling thread for null
+        template <typename F>
+        PromisePtr<typename PromiseChain<typename std::result_of<F(const T &)>::type>::ValueType>
+        Then(const std::shared_ptr<TaskQueue> & queue, const F & on_value) {
+            using Chain = PromiseChain<typename std::result_of<F(const T &)>::type>;
+            auto next = Promise<typename Chain::ValueType>::Create();
+            Subscribe(queue, [next, on_value](const Promise<T> & settled) {
+                if (settled.value_) {
+                    Chain::Call(on_value, *settled.value_, next);
+                } else {
+                    next->Reject(settled.error_);
+                }
+            });
+            return next;
+        }
+        
+        //  on_error runs on the current queue for a rejection anywhere before in the chain
+        void Catch(const std::function<void(const std::string &)> & on_error) {
+            Subscribe(TaskQueue::current_queue(), [on_error](const Promise<T> & settled) {
+                if (!settled.value_) {
+                    on_error(settled.error_);
+                }
+            });
+        }
+        
+        //  settles next in the same way as this
+        void Pipe(const PromisePtr<T> & next) {
+            Subscribe(nullptr, [next](const Promise<T> & settled) {
+                if (settled.value_) {
+                    next->Resolve(*settled.value_);
+                } else {
+                    next->Reject(settled.error_);
+                }
+            });
+        }
+    private:
+        //  takes the settled promise instead of capturing it,
+        //  so a promise never settled is freed with its continuations
+        using Callback = std::function<void(const Promise<T> &)>;
+        
+        struct Continuation {
+            std::shared_ptr<TaskQueue> queue;
+            Callback callback;
+        };
+        
+        void Dispatch(const std::shared_ptr<TaskQueue> & queue, Callback && callback) {
+            if (queue) {
+                auto thiz = this->shared_from_this();
+                queue->PostTask(Task(NWR_HERE, [thiz, callback = std::move(callback)]{
+                    callback(*thiz);
+                }));
+            } else {
+                callback(*this);
+            }
+        }
+        
+        void Subscribe(const std::shared_ptr<TaskQueue> & queue, Callback && callback) {
+            {
+                std::lock_guard<std::mutex> lk(mutex_);
+                if (!settled_) {
+                    continuations_.push_back(Continuation { queue, std::move(callback) });
+                    return;
+                }
+            }
+            Dispatch(queue, std::move(callback));
+        }
+        
+        void Settle(std::unique_ptr<T> && value, const std::string & error) {
+            std::vector<Continuation> continuations;
+            {
+                std::lock_guard<std::mutex> lk(mutex_);
+                if (settled_) { return; }
+                settled_ = true;
+                //  not changed any more, so the continuations read them without the lock
+                value_ = std::move(value);
+                error_ = error;
+                continuations.swap(continuations_);
+            }
+            for (auto & continuation : continuations) {
+                Dispatch(continuation.queue, std::move(continuation.callback));
+            }
+        }
+        
+        std::mutex mutex_;
+        bool settled_;
+        //  null when rejected
+        std::unique_ptr<T> value_;
+        std::string error_;
+        std::vector<Continuation> continuations_;
+    };
+    
+    template <typename R>
+    struct PromiseChain {
+        using ValueType = R;
+        template <typename F, typename A>
+        static void Call(const F & func, const A & arg, const PromisePtr<R> & next) {
+            next->Resolve(func(arg));
+        }
+    };
+    
+    template <>
+    struct PromiseChain<void> {
+        using ValueType = None;
+        template <typename F, typename A>
+        static void Call(const F & func, const A & arg, const PromisePtr<None> & next) {
+            func(arg);
+            next->Resolve(None());
+        }
+    };
+    
+    template <typename U>
+    struct PromiseChain<PromisePtr<U>> {
+        using ValueType = U;
+        template <typename F, typename A>
+        static void Call(const F & func, const A & arg, const PromisePtr<U> & next) {
+            auto inner = func(arg);
+            if (inner) {
+                inner->Pipe(next);
+            }
+        }
+    };
+}
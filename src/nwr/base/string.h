@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <cstdarg>
 #include <cctype>
 #include <regex>
 #include <functional>
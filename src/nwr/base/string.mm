@@ -164,6 +164,7 @@ namespace nwr {
         return ss.str();
     }
     
+#ifdef __OBJC__
     std::string ToString(NSString * str) {
         return std::string([str UTF8String]);
     }
@@ -171,5 +172,6 @@ namespace nwr {
     NSString * ToNSString(const std::string & str, NSStringEncoding encoding) {
         return [NSString stringWithCString:str.c_str() encoding:encoding];
     }
+#endif
 }
 
@@ -8,8 +8,163 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//  the call site of a post, as a string literal
+#define NWR_STRINGIFY_IMPL(x) #x
+#define NWR_STRINGIFY(x) NWR_STRINGIFY_IMPL(x)
+#define NWR_HERE (__FILE__ ":" NWR_STRINGIFY(__LINE__))
 
 namespace nwr {
-    using Task = std::function<void()>;
+    //  a unit of work posted to a queue and called once.
+    //  move only, so a posted closure is never copied on its way,
+    //  and a closure up to kInlineSize bytes is stored inline without allocation.
+    //  the size fits a shared_ptr and a Websocket::Message.
+    class Task {
+    public:
+        static constexpr size_t kInlineSize = 48;
+        
+        Task() noexcept: ops_(nullptr), location_(nullptr) {}
+        Task(std::nullptr_t) noexcept: ops_(nullptr), location_(nullptr) {}
+        
+        template <typename F,
+                  typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+        Task(F && func): ops_(nullptr), location_(nullptr) {
+            using Func = typename std::decay<F>::type;
+            Construct<Func>(std::forward<F>(func), IsInline<Func>());
+        }
+        
+        //  tagged with the call site, as Task(NWR_HERE, [..]{ .. })
+        template <typename F>
+        Task(const char * location, F && func): Task(std::forward<F>(func)) {
+            location_ = location;
+        }
+        
+        Task(Task && other) noexcept: ops_(nullptr), location_(nullptr) {
+            MoveFrom(other);
+        }
+        Task & operator= (Task && other) noexcept {
+            if (this != &other) {
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+        Task & operator= (std::nullptr_t) noexcept {
+            Reset();
+            return *this;
+        }
+        Task(const Task &) = delete;
+        Task & operator= (const Task &) = delete;
+        
+        ~Task() {
+            Reset();
+        }
+        
+        void operator() () {
+            ops_->invoke(&storage_);
+        }
+        explicit operator bool() const {
+            return ops_ != nullptr;
+        }
+        
+        //  the call site, or null
+        const char * location() const { return location_; }
+    private:
+        using Storage = typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type;
+        
+        struct Ops {
+            void (*invoke)(Storage * storage);
+            //  move constructs into dest and destroys src
+            void (*relocate)(Storage * dest, Storage * src);
+            void (*destroy)(Storage * storage);
+        };
+        
+        template <typename Func>
+        using IsInline = std::integral_constant<bool,
+        sizeof(Func) <= kInlineSize &&
+        alignof(Func) <= alignof(Storage) &&
+        std::is_nothrow_move_constructible<Func>::value>;
+        
+        template <typename Func>
+        struct InlineOps {
+            static Func * get(Storage * storage) {
+                return reinterpret_cast<Func *>(storage);
+            }
+            static void invoke(Storage * storage) {
+                (*get(storage))();
+            }
+            static void relocate(Storage * dest, Storage * src) {
+                new (dest) Func(std::move(*get(src)));
+                get(src)->~Func();
+            }
+            static void destroy(Storage * storage) {
+                get(storage)->~Func();
+            }
+            static const Ops ops;
+        };
+        
+        template <typename Func>
+        struct HeapOps {
+            static Func *& get(Storage * storage) {
+                return *reinterpret_cast<Func **>(storage);
+            }
+            static void invoke(Storage * storage) {
+                (*get(storage))();
+            }
+            static void relocate(Storage * dest, Storage * src) {
+                new (dest) Func *(get(src));
+            }
+            static void destroy(Storage * storage) {
+                delete get(storage);
+            }
+            static const Ops ops;
+        };
+        
+        template <typename Func, typename F>
+        void Construct(F && func, std::true_type) {
+            new (&storage_) Func(std::forward<F>(func));
+            ops_ = &InlineOps<Func>::ops;
+        }
+        template <typename Func, typename F>
+        void Construct(F && func, std::false_type) {
+            new (&storage_) Func *(new Func(std::forward<F>(func)));
+            ops_ = &HeapOps<Func>::ops;
+        }
+        
+        void MoveFrom(Task & other) noexcept {
+            if (other.ops_) {
+                other.ops_->relocate(&storage_, &other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+            location_ = other.location_;
+            other.location_ = nullptr;
+        }
+        void Reset() noexcept {
+            if (ops_) {
+                ops_->destroy(&storage_);
+                ops_ = nullptr;
+            }
+            location_ = nullptr;
+        }
+        
+        const Ops * ops_;
+        const char * location_;
+        Storage storage_;
+    };
+    
+    template <typename Func>
+    const Task::Ops Task::InlineOps<Func>::ops = {
+        &InlineOps<Func>::invoke, &InlineOps<Func>::relocate, &InlineOps<Func>::destroy
+    };
+    template <typename Func>
+    const Task::Ops Task::HeapOps<Func>::ops = {
+        &HeapOps<Func>::invoke, &HeapOps<Func>::relocate, &HeapOps<Func>::destroy
+    };
 }
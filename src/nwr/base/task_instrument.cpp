@@ -0,0 +1,207 @@
+//
+//  task_instrument.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "task_instrument.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "string.h"
+
+namespace nwr {
+    namespace {
+        //  null is the location of the untagged tasks
+        int CompareLiteral(const char * a, const char * b) {
+            if (a == b) { return 0; }
+            return strcmp(a ? a : "", b ? b : "");
+        }
+    }
+    
+    LatencyHistogram::LatencyHistogram():
+    counts_(kBucketCount, 0),
+    count_(0),
+    sum_(0),
+    min_(0),
+    max_(0)
+    {}
+    
+    void LatencyHistogram::Record(int64_t value_us) {
+        value_us = std::max<int64_t>(0, value_us);
+        counts_[BucketIndex(value_us)] += 1;
+        if (count_ == 0 || value_us < min_) {
+            min_ = value_us;
+        }
+        max_ = std::max(max_, value_us);
+        count_ += 1;
+        sum_ += value_us;
+    }
+    
+    double LatencyHistogram::mean() const {
+        if (count_ == 0) { return 0; }
+        return static_cast<double>(sum_) / static_cast<double>(count_);
+    }
+    
+    int64_t LatencyHistogram::ValueAtRatio(double ratio) const {
+        if (count_ == 0) { return 0; }
+        ratio = std::min(1.0, std::max(0.0, ratio));
+        const int64_t rank = std::max<int64_t>(1, static_cast<int64_t>(ratio * count_ + 0.5));
+        int64_t seen = 0;
+        for (int i = 0; i < kBucketCount; i++) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                //  the bucket bound may pass the real max
+                return std::min(max_, BucketLowest(i + 1) - 1);
+            }
+        }
+        return max_;
+    }
+    
+    LatencyHistogram & LatencyHistogram::operator+= (const LatencyHistogram & other) {
+        if (other.count_ == 0) { return *this; }
+        for (int i = 0; i < kBucketCount; i++) {
+            counts_[i] += other.counts_[i];
+        }
+        if (count_ == 0 || other.min_ < min_) {
+            min_ = other.min_;
+        }
+        max_ = std::max(max_, other.max_);
+        count_ += other.count_;
+        sum_ += other.sum_;
+        return *this;
+    }
+    
+    int LatencyHistogram::BucketIndex(int64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<int>(value);
+        }
+        //  the top kSubBucketBits + 1 bits pick the bucket
+        int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+        if (exponent > kMaxExponent) {
+            return kBucketCount - 1;
+        }
+        const int shift = exponent - kSubBucketBits;
+        const int mantissa = static_cast<int>(value >> shift);
+        return (shift + 1) * kSubBucketCount + (mantissa - kSubBucketCount);
+    }
+    
+    int64_t LatencyHistogram::BucketLowest(int index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        const int shift = index / kSubBucketCount - 1;
+        const int64_t mantissa = kSubBucketCount + index % kSubBucketCount;
+        return mantissa << shift;
+    }
+    
+    std::string ToString(const LatencyHistogram & histogram) {
+        return Format("n=%lld mean=%.0fus p50=%lldus p90=%lldus p99=%lldus max=%lldus",
+                      static_cast<long long>(histogram.count()),
+                      histogram.mean(),
+                      static_cast<long long>(histogram.ValueAtRatio(0.5)),
+                      static_cast<long long>(histogram.ValueAtRatio(0.9)),
+                      static_cast<long long>(histogram.ValueAtRatio(0.99)),
+                      static_cast<long long>(histogram.max()));
+    }
+    
+    TaskInstrument & TaskInstrument::shared() {
+        static TaskInstrument instrument;
+        return instrument;
+    }
+    
+    TaskInstrument::TaskInstrument():
+    enabled_(false),
+    slow_threshold_(0)
+    {}
+    
+    bool TaskInstrument::SiteKeyLess::operator()(const SiteKey & a, const SiteKey & b) const {
+        const int queue = CompareLiteral(a.first, b.first);
+        if (queue != 0) { return queue < 0; }
+        return CompareLiteral(a.second, b.second) < 0;
+    }
+    
+    void TaskInstrument::set_enabled(bool value) {
+        enabled_.store(value, std::memory_order_relaxed);
+    }
+    
+    void TaskInstrument::set_slow_task_callback(const TimeDuration & threshold,
+                                                const SlowTaskCallback & callback)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        slow_threshold_ = threshold;
+        slow_callback_ = callback;
+    }
+    
+    std::vector<TaskInstrument::SiteStats> TaskInstrument::Snapshot() {
+        std::vector<SiteStats> ret;
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (const auto & entry : sites_) {
+            SiteStats stats;
+            stats.queue = entry.first.first;
+            stats.location = entry.first.second ? entry.first.second : "";
+            stats.queue_delay = entry.second.queue_delay;
+            stats.run_time = entry.second.run_time;
+            ret.push_back(std::move(stats));
+        }
+        return ret;
+    }
+    
+    void TaskInstrument::Reset() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        sites_.clear();
+    }
+    
+    Task TaskInstrument::Wrap(const char * queue, Task && task) {
+        if (!enabled()) {
+            return std::move(task);
+        }
+        using Clock = std::chrono::steady_clock;
+        const char * location = task.location();
+        const auto posted_at = Clock::now();
+        return Task(location, [this, queue, location, posted_at, task = std::move(task)]() mutable {
+            const auto started_at = Clock::now();
+            task();
+            const auto finished_at = Clock::now();
+            Record(queue, location,
+                   std::chrono::duration_cast<TimeDuration>(started_at - posted_at),
+                   std::chrono::duration_cast<TimeDuration>(finished_at - started_at));
+        });
+    }
+    
+    void TaskInstrument::Record(const char * queue, const char * location,
+                                const TimeDuration & queue_delay, const TimeDuration & run_time)
+    {
+        using std::chrono::microseconds;
+        using std::chrono::duration_cast;
+        SlowTaskCallback callback;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            Site & site = sites_[SiteKey(queue, location)];
+            site.queue_delay.Record(duration_cast<microseconds>(queue_delay).count());
+            site.run_time.Record(duration_cast<microseconds>(run_time).count());
+            if (slow_callback_ && run_time >= slow_threshold_) {
+                callback = slow_callback_;
+            }
+        }
+        //  out of the lock, so the callback may take a Snapshot
+        if (callback) {
+            callback(SlowTask { queue, location, queue_delay, run_time });
+        }
+    }
+    
+    std::string ToString(const std::vector<TaskInstrument::SiteStats> & stats) {
+        std::vector<std::string> lines;
+        for (const auto & site : stats) {
+            lines.push_back(Format("%s %s\n  delay: %s\n  run: %s",
+                                   site.queue.c_str(),
+                                   site.location.size() > 0 ? site.location.c_str() : "(untagged)",
+                                   ToString(site.queue_delay).c_str(),
+                                   ToString(site.run_time).c_str()));
+        }
+        return Join(lines, "\n");
+    }
+}
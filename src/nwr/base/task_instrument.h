@@ -0,0 +1,126 @@
+//
+//  task_instrument.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "task.h"
+#include "time.h"
+
+namespace nwr {
+    //  a histogram of microseconds in the way of HdrHistogram.
+    //  16 linear buckets for every power of two, so a value is kept within 1/16,
+    //  in a fixed array from 0 to about 2^40 us.
+    class LatencyHistogram {
+    public:
+        static constexpr int kSubBucketBits = 4;
+        static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+        static constexpr int kMaxExponent = 40;
+        static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBucketCount;
+        
+        LatencyHistogram();
+        
+        void Record(int64_t value_us);
+        
+        int64_t count() const { return count_; }
+        int64_t min() const { return count_ > 0 ? min_ : 0; }
+        int64_t max() const { return max_; }
+        double mean() const;
+        //  the upper bound of the bucket holding the value at ratio, 0 to 1
+        int64_t ValueAtRatio(double ratio) const;
+        
+        LatencyHistogram & operator+= (const LatencyHistogram & other);
+        
+        static int BucketIndex(int64_t value);
+        static int64_t BucketLowest(int index);
+    private:
+        std::vector<int64_t> counts_;
+        int64_t count_;
+        int64_t sum_;
+        int64_t min_;
+        int64_t max_;
+    };
+    
+    std::string ToString(const LatencyHistogram & histogram);
+    
+    //  records how long posted tasks wait and run, per queue and call site.
+    //  off by default; while off, a post costs one atomic load more.
+    //  every PostTask implementation passes its task through Wrap.
+    //  the call site is Task::location, and untagged tasks are counted per queue.
+    class TaskInstrument {
+    public:
+        struct SiteStats {
+            std::string queue;
+            //  empty for the untagged tasks
+            std::string location;
+            //  from PostTask to the start of the run
+            LatencyHistogram queue_delay;
+            LatencyHistogram run_time;
+        };
+        
+        struct SlowTask {
+            const char * queue;
+            const char * location;
+            TimeDuration queue_delay;
+            TimeDuration run_time;
+        };
+        using SlowTaskCallback = std::function<void(const SlowTask &)>;
+        
+        static TaskInstrument & shared();
+        
+        TaskInstrument();
+        TaskInstrument(const TaskInstrument &) = delete;
+        TaskInstrument & operator= (const TaskInstrument &) = delete;
+        
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+        void set_enabled(bool value);
+        
+        //  called on the thread of the task, after a run longer than threshold.
+        //  it should not block, as the queue waits for it.
+        void set_slow_task_callback(const TimeDuration & threshold,
+                                    const SlowTaskCallback & callback);
+        
+        std::vector<SiteStats> Snapshot();
+        void Reset();
+        
+        //  queue is a string literal naming the queue class.
+        //  returns task as is while disabled
+        Task Wrap(const char * queue, Task && task);
+    private:
+        using SiteKey = std::pair<const char *, const char *>;
+        //  compares the contents, as a literal may have a copy per translation unit
+        struct SiteKeyLess {
+            bool operator()(const SiteKey & a, const SiteKey & b) const;
+        };
+        struct Site {
+            LatencyHistogram queue_delay;
+            LatencyHistogram run_time;
+        };
+        
+        void Record(const char * queue, const char * location,
+                    const TimeDuration & queue_delay, const TimeDuration & run_time);
+        
+        std::atomic<bool> enabled_;
+        
+        std::mutex mutex_;
+        //  keyed by the literals themselves, so a record does not build a string
+        std::map<SiteKey, Site, SiteKeyLess> sites_;
+        TimeDuration slow_threshold_;
+        SlowTaskCallback slow_callback_;
+    };
+    
+    std::string ToString(const std::vector<TaskInstrument::SiteStats> & stats);
+}
@@ -12,12 +12,18 @@
 #include <memory>
 
 #include "task.h"
+#include "timer_service.h"
 
 namespace nwr {
     class TaskQueue: public std::enable_shared_from_this<TaskQueue> {
     public:
         virtual ~TaskQueue() {}
-        virtual void PostTask(const Task & task) = 0;
+        virtual void PostTask(Task && task) = 0;
+        
+        //  the timers and the clock of the tasks on this queue
+        virtual std::shared_ptr<TimerService> timer_service() {
+            return TimerService::shared();
+        }
         
         static std::shared_ptr<TaskQueue> current_queue();
     };
@@ -9,9 +9,13 @@
 #include "task_queue.h"
 
 #include "ios_task_queue.h"
+#include "virtual_time_queue.h"
 
 namespace nwr {
     std::shared_ptr<TaskQueue> TaskQueue::current_queue() {
+        if (VirtualTimeQueue * queue = VirtualTimeQueue::current()) {
+            return queue->shared_from_this();
+        }
         return IosTaskQueue::current_queue();
     }
 }
@@ -9,18 +9,17 @@
 #include "timer.h"
 
 #include "task_queue.h"
-#include "looper.h"
 
 namespace nwr {
-    TimerPtr Timer::Create(const TimeDuration & delay, const Task & task) {
-        return Create(delay, std::chrono::duration<double>(-1), task);
+    TimerPtr Timer::Create(const TimeDuration & delay, const Callback & callback) {
+        return Create(delay, std::chrono::duration<double>(-1), callback);
     }
     TimerPtr Timer::Create(const TimeDuration & delay,
                            const TimeDuration & interval,
-                           const Task & task)
+                           const Callback & callback)
     {
         TimerPtr thiz(new Timer());
-        thiz->Init(delay, interval, task);
+        thiz->Init(delay, interval, callback);
         return thiz;
     }
     Timer::~Timer() {
@@ -31,6 +30,12 @@ namespace nwr {
             return;
         }
         cancelled_ = true;
+        
+        //  not fired yet, so end here instead of at the deadline
+        if (entry_ && service_->Cancel(entry_)) {
+            entry_ = nullptr;
+            queue_->PostTask(Task(NWR_HERE, std::bind(&Timer::OnTimer, this)));
+        }
     }
     Timer::Timer():
     timer_emitter_(std::make_shared<Emitter<None>>()),
@@ -39,45 +44,61 @@ namespace nwr {
     
     void Timer::Init(const TimeDuration & delay,
                      const TimeDuration & interval,
-                     const Task & task)
+                     const Callback & callback)
     {
         queue_ = TaskQueue::current_queue();
         delay_ = delay;
         interval_ = interval;
         repeat_count_ = 0;
         cycle_ = shared_from_this();
-        looper_ = Looper::Create();
+        service_ = queue_->timer_service();
         cancelled_ = false;
         
-        timer_emitter_->On([task](None none){
-            task();
+        timer_emitter_->On([callback](None){
+            callback();
         });
         
-        looper_->PostTask([this]{
-            std::this_thread::sleep_for(this->delay_);
-            queue_->PostTask(std::bind(&Timer::OnTimer, this));
+        Schedule(service_->now() +
+                 std::chrono::duration_cast<TimerService::Clock::duration>(delay_));
+    }
+    void Timer::Schedule(const TimerService::Clock::time_point & deadline) {
+        deadline_ = deadline;
+        //  cycle_ keeps this alive until OnTimer ends it
+        auto queue = queue_;
+        entry_ = service_->Schedule(deadline, [this, queue]{
+            queue->PostTask(Task(NWR_HERE, std::bind(&Timer::OnTimer, this)));
         });
     }
     void Timer::OnTimer() {
+        entry_ = nullptr;
+        
         if (!cancelled_) {
             repeat_count_ += 1;
             timer_emitter_->Emit(None());
         }
         
         if (interval_ < std::chrono::seconds(0) || cancelled_) {
-            looper_->Quit();
-            looper_ = nullptr;
-            
             end_emitter_->Emit(None());
             
             cycle_ = nullptr;
             return;
         }
         
-        looper_->PostTask([this]{
-            std::this_thread::sleep_for(this->interval_);
-            queue_->PostTask(std::bind(&Timer::OnTimer, this));
-        });
+        //  from the last deadline so the period does not drift, but never in the past
+        auto now = service_->now();
+        auto deadline = deadline_ + std::chrono::duration_cast<TimerService::Clock::duration>(interval_);
+        Schedule(std::max(deadline, now));
+    }
+    
+    PromisePtr<None> Sleep(const TimeDuration & delay) {
+        auto promise = Promise<None>::Create();
+        auto service = TaskQueue::current_queue()->timer_service();
+        service->Schedule(service->now() +
+                          std::chrono::duration_cast<TimerService::Clock::duration>(delay),
+                          [promise]{
+                              promise->Resolve(None());
+                          });
+        return promise;
     }
 }
 
@@ -16,6 +16,8 @@
 #include "none.h"
 #include "time.h"
 #include "emitter.h"
+#include "promise.h"
+#include "timer_service.h"
 
 namespace nwr {
     class Timer;
@@ -23,15 +25,18 @@ namespace nwr {
     using TimerPtr = std::shared_ptr<Timer>;
     
     class TaskQueue;
-    class Looper;
     
+    //  runs on the TimerService of the queue of its creation, then calls back there
     class Timer: public std::enable_shared_from_this<Timer> {
     public:
+        //  the callback is called on every tick, so it is copyable unlike Task
+        using Callback = std::function<void()>;
+        
         static TimerPtr Create(const TimeDuration & delay,
-                               const Task & task);
+                               const Callback & callback);
         static TimerPtr Create(const TimeDuration & delay,
                                const TimeDuration & interval,
-                               const Task & task);
+                               const Callback & callback);
         virtual ~Timer();
         int repeat_count() { return repeat_count_; }
         EmitterPtr<None> timer_emitter() { return timer_emitter_; }
@@ -41,8 +46,8 @@ namespace nwr {
         Timer();
         void Init(const TimeDuration & delay,
                   const TimeDuration & interval,
-                  const Task & task);
-        void ThreadMain();
+                  const Callback & callback);
+        void Schedule(const TimerService::Clock::time_point & deadline);
         void OnTimer();
         std::shared_ptr<TaskQueue> queue_;
         TimeDuration delay_;
@@ -54,7 +59,13 @@ namespace nwr {
         EmitterPtr<None> timer_emitter_;
         EmitterPtr<None> end_emitter_;
         
-        std::shared_ptr<Looper> looper_;
+        std::shared_ptr<TimerService> service_;
+        TimerService::EntryPtr entry_;
+        TimerService::Clock::time_point deadline_;
         bool cancelled_;
     };
+    
+    //  resolved on the TimerService of the current queue after delay, without a Timer.
+    //  the continuations run on their own queues as usual.
+    PromisePtr<None> Sleep(const TimeDuration & delay);
 }
@@ -29,7 +29,7 @@ namespace nwr {
     void TimerPool::Remove(const TimerPtr & timer) {
         nwr::Remove(timers_, timer);
     }
-    void TimerPool::SetTimeout(const TimeDuration & delay, const Task & task) {
-        Add(Timer::Create(delay, task));
+    void TimerPool::SetTimeout(const TimeDuration & delay, const Timer::Callback & callback) {
+        Add(Timer::Create(delay, callback));
     }
 }
\ No newline at end of file
@@ -23,7 +23,7 @@ namespace nwr {
         void Add(const TimerPtr & timer);
         void Remove(const TimerPtr & timer);
         
-        void SetTimeout(const TimeDuration & delay, const Task & task);
+        void SetTimeout(const TimeDuration & delay, const Timer::Callback & callback);
     private:
         std::vector<TimerPtr> timers_;
     };
@@ -0,0 +1,228 @@
+//
+//  timer_service.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "timer_service.h"
+
+#include <algorithm>
+
+namespace nwr {
+    std::shared_ptr<TimerService> TimerService::shared() {
+        static std::shared_ptr<TimerService> service = std::make_shared<TimerService>();
+        return service;
+    }
+    
+    TimerService::TimerService():
+    next_sequence_(0),
+    virtual_(false),
+    quit_(false)
+    {
+        thread_ = std::thread([this]{
+            ThreadMain();
+        });
+    }
+    
+    TimerService::TimerService(const Clock::time_point & start):
+    next_sequence_(0),
+    virtual_(true),
+    virtual_now_(start),
+    quit_(false)
+    {}
+    
+    TimerService::TimerService(const std::function<void()> & wakeup):
+    next_sequence_(0),
+    virtual_(false),
+    quit_(false),
+    wakeup_(wakeup)
+    {}
+    
+    TimerService::~TimerService() {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            quit_ = true;
+        }
+        cond_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        
+        for (auto & entry : heap_) {
+            entry->heap_index = kNotScheduled;
+        }
+    }
+    
+    TimerService::EntryPtr TimerService::Schedule(const Clock::time_point & deadline, Task && task) {
+        auto entry = std::make_shared<Entry>();
+        entry->deadline = deadline;
+        entry->task = std::move(task);
+        
+        bool earliest;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            entry->sequence = next_sequence_;
+            next_sequence_ += 1;
+            entry->heap_index = heap_.size();
+            heap_.push_back(entry);
+            SiftUp(entry->heap_index);
+            earliest = entry->heap_index == 0;
+            if (earliest && wakeup_) {
+                wakeup_();
+            }
+        }
+        //  the thread waits for the former top
+        if (earliest) {
+            cond_.notify_one();
+        }
+        return entry;
+    }
+    
+    bool TimerService::Cancel(const EntryPtr & entry) {
+        //  destroyed after the unlock, its captures may cancel or schedule other timers
+        Task task;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (entry->heap_index == kNotScheduled) {
+                return false;
+            }
+            //  a thread waiting for a removed top wakes at its deadline and waits again
+            RemoveAt(entry->heap_index);
+            task = std::move(entry->task);
+        }
+        return true;
+    }
+    
+    size_t TimerService::pending_count() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return heap_.size();
+    }
+    
+    TimerService::Clock::time_point TimerService::now() {
+        if (!virtual_) {
+            return Clock::now();
+        }
+        std::lock_guard<std::mutex> lk(mutex_);
+        return virtual_now_;
+    }
+    
+    bool TimerService::next_deadline(Clock::time_point & deadline) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (heap_.size() == 0) {
+            return false;
+        }
+        deadline = heap_[0]->deadline;
+        return true;
+    }
+    
+    void TimerService::AdvanceTo(const Clock::time_point & time) {
+        std::unique_lock<std::mutex> lk(mutex_);
+        while (heap_.size() > 0 && heap_[0]->deadline <= time) {
+            EntryPtr entry = heap_[0];
+            RemoveAt(0);
+            Task task = std::move(entry->task);
+            //  a deadline in the past runs at the current time
+            virtual_now_ = std::max(virtual_now_, entry->deadline);
+            
+            lk.unlock();
+            task();
+            task = nullptr;
+            lk.lock();
+        }
+        virtual_now_ = std::max(virtual_now_, time);
+    }
+    
+    void TimerService::ClearWakeup() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        wakeup_ = nullptr;
+    }
+    
+    void TimerService::ThreadMain() {
+        std::unique_lock<std::mutex> lk(mutex_);
+        while (!quit_) {
+            if (heap_.size() == 0) {
+                cond_.wait(lk);
+                continue;
+            }
+            
+            const auto deadline = heap_[0]->deadline;
+            if (Clock::now() < deadline) {
+                cond_.wait_until(lk, deadline);
+                continue;
+            }
+            
+            EntryPtr entry = heap_[0];
+            RemoveAt(0);
+            Task task = std::move(entry->task);
+            
+            lk.unlock();
+            task();
+            task = nullptr;
+            lk.lock();
+        }
+    }
+    
+    bool TimerService::Less(size_t a, size_t b) const {
+        const auto & x = *heap_[a];
+        const auto & y = *heap_[b];
+        if (x.deadline != y.deadline) {
+            return x.deadline < y.deadline;
+        }
+        return x.sequence < y.sequence;
+    }
+    
+    void TimerService::Swap(size_t a, size_t b) {
+        std::swap(heap_[a], heap_[b]);
+        heap_[a]->heap_index = a;
+        heap_[b]->heap_index = b;
+    }
+    
+    void TimerService::SiftUp(size_t index) {
+        while (index > 0) {
+            size_t parent = (index - 1) / 2;
+            if (!Less(index, parent)) {
+                break;
+            }
+            Swap(index, parent);
+            index = parent;
+        }
+    }
+    
+    void TimerService::SiftDown(size_t index) {
+        while (true) {
+            size_t least = index;
+            size_t left = index * 2 + 1;
+            size_t right = left + 1;
+            if (left < heap_.size() && Less(left, least)) {
+                least = left;
+            }
+            if (right < heap_.size() && Less(right, least)) {
+                least = right;
+            }
+            if (least == index) {
+                break;
+            }
+            Swap(index, least);
+            index = least;
+        }
+    }
+    
+    void TimerService::RemoveAt(size_t index) {
+        heap_[index]->heap_index = kNotScheduled;
+        
+        size_t last = heap_.size() - 1;
+        if (index != last) {
+            heap_[index] = heap_[last];
+            heap_[index]->heap_index = index;
+        }
+        heap_.pop_back();
+        
+        if (index < heap_.size()) {
+            //  the moved entry may go either way
+            SiftUp(index);
+            SiftDown(index);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+//
+//  timer_service.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+#include "task.h"
+
+namespace nwr {
+    //  one thread running every scheduled task at its deadline.
+    //  pending tasks are kept in a binary min-heap, so Schedule and Cancel are O(log n).
+    //  tasks run on the service thread; post to a TaskQueue for anything longer.
+    //  a virtual one has no thread and runs on simulated time by AdvanceTo,
+    //  for VirtualTimeQueue.
+    //  a driven one has no thread either and runs on the real clock by AdvanceTo
+    //  from the loop owning it, as LinuxLooper on its timerfd.
+    class TimerService {
+    public:
+        using Clock = std::chrono::steady_clock;
+        
+        struct Entry {
+            Clock::time_point deadline;
+            //  orders entries of the same deadline by Schedule
+            uint64_t sequence;
+            Task task;
+            //  position in the heap, or kNotScheduled
+            size_t heap_index;
+        };
+        using EntryPtr = std::shared_ptr<Entry>;
+        
+        static constexpr size_t kNotScheduled = static_cast<size_t>(-1);
+        
+        //  the process wide service
+        static std::shared_ptr<TimerService> shared();
+        
+        TimerService();
+        //  virtual, starting at start
+        explicit TimerService(const Clock::time_point & start);
+        //  driven. wakeup is called under the lock, from the thread of Schedule,
+        //  when a task becomes the earliest, so the loop rearms its timer.
+        //  it must not call back into this
+        explicit TimerService(const std::function<void()> & wakeup);
+        ~TimerService();
+        TimerService(const TimerService &) = delete;
+        TimerService & operator= (const TimerService &) = delete;
+        
+        EntryPtr Schedule(const Clock::time_point & deadline, Task && task);
+        //  true if removed before it ran
+        bool Cancel(const EntryPtr & entry);
+        
+        size_t pending_count();
+        
+        bool is_virtual() const { return virtual_; }
+        //  Clock::now(), or the virtual time
+        Clock::time_point now();
+        //  false if nothing is scheduled
+        bool next_deadline(Clock::time_point & deadline);
+        //  virtual or driven only. runs the tasks due by time on the caller in order,
+        //  moving the virtual time to each deadline, and then to time
+        void AdvanceTo(const Clock::time_point & time);
+        //  driven only. no wakeup is called after this, for the loop going away
+        void ClearWakeup();
+    private:
+        void ThreadMain();
+        
+        //  under mutex_
+        bool Less(size_t a, size_t b) const;
+        void Swap(size_t a, size_t b);
+        void SiftUp(size_t index);
+        void SiftDown(size_t index);
+        void RemoveAt(size_t index);
+        
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::vector<EntryPtr> heap_;
+        uint64_t next_sequence_;
+        bool virtual_;
+        Clock::time_point virtual_now_;
+        bool quit_;
+        std::function<void()> wakeup_;
+        std::thread thread_;
+    };
+}
@@ -0,0 +1,89 @@
+//
+//  virtual_time_queue.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "virtual_time_queue.h"
+
+#include "task_instrument.h"
+
+namespace nwr {
+    namespace {
+        thread_local VirtualTimeQueue * current_virtual_queue = nullptr;
+    }
+    
+    VirtualTimeQueue * VirtualTimeQueue::current() {
+        return current_virtual_queue;
+    }
+    
+    VirtualTimeQueue::VirtualTimeQueue():
+    start_(),
+    run_task_count_(0)
+    {
+        timer_service_ = std::make_shared<TimerService>(start_);
+    }
+    
+    VirtualTimeQueue::~VirtualTimeQueue() {
+    }
+    
+    void VirtualTimeQueue::PostTask(Task && task) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        tasks_.push_back(TaskInstrument::shared().Wrap("VirtualTimeQueue", std::move(task)));
+    }
+    
+    TimeDuration VirtualTimeQueue::elapsed() {
+        return std::chrono::duration_cast<TimeDuration>(now() - start_);
+    }
+    
+    void VirtualTimeQueue::RunFor(const TimeDuration & duration) {
+        const auto end = now() + std::chrono::duration_cast<Clock::duration>(duration);
+        RunUntil(&end);
+    }
+    
+    void VirtualTimeQueue::RunUntilIdle() {
+        RunUntil(nullptr);
+    }
+    
+    bool VirtualTimeQueue::RunTask() {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (tasks_.size() == 0) {
+                return false;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+        run_task_count_ += 1;
+        return true;
+    }
+    
+    void VirtualTimeQueue::RunUntil(const Clock::time_point * end) {
+        VirtualTimeQueue * outer = current_virtual_queue;
+        current_virtual_queue = this;
+        
+        while (true) {
+            if (RunTask()) {
+                continue;
+            }
+            //  idle, so the time goes on to the next timer
+            Clock::time_point deadline;
+            if (!timer_service_->next_deadline(deadline) ||
+                (end && *end < deadline))
+            {
+                break;
+            }
+            //  the due timers post to their queues, this one included
+            timer_service_->AdvanceTo(deadline);
+        }
+        if (end) {
+            timer_service_->AdvanceTo(*end);
+        }
+        
+        current_virtual_queue = outer;
+    }
+}
@@ -0,0 +1,64 @@
+//
+//  virtual_time_queue.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "task_queue.h"
+#include "time.h"
+#include "timer_service.h"
+
+namespace nwr {
+    //  a TaskQueue on simulated time, for tests and benchmarks of timer driven code.
+    //  tasks run on the thread calling RunFor, and the clock jumps to the next deadline
+    //  as soon as no task is left, so an hour of heartbeats runs in a moment.
+    //  Timer and Sleep created on this queue use its virtual TimerService,
+    //  and the same posts in the same order always run the same way.
+    //  a post from another thread, as from a WorkerPool, is run when it arrives,
+    //  so it is not deterministic in virtual time.
+    class VirtualTimeQueue: public TaskQueue {
+    public:
+        using Clock = TimerService::Clock;
+        
+        //  the queue running tasks on this thread, or null
+        static VirtualTimeQueue * current();
+        
+        VirtualTimeQueue();
+        virtual ~VirtualTimeQueue();
+        
+        //  from any thread
+        void PostTask(Task && task) override;
+        std::shared_ptr<TimerService> timer_service() override { return timer_service_; }
+        
+        Clock::time_point now() { return timer_service_->now(); }
+        //  the virtual time since the creation
+        TimeDuration elapsed();
+        int64_t run_task_count() const { return run_task_count_; }
+        
+        //  runs the tasks and the timers due within duration, then moves the clock to its end
+        void RunFor(const TimeDuration & duration);
+        //  runs until no task is left and no timer is scheduled.
+        //  a repeating timer never ends, so use RunFor with it
+        void RunUntilIdle();
+    private:
+        //  false if no task is left
+        bool RunTask();
+        void RunUntil(const Clock::time_point * end);
+        
+        std::shared_ptr<TimerService> timer_service_;
+        Clock::time_point start_;
+        
+        std::mutex mutex_;
+        std::deque<Task> tasks_;
+        
+        int64_t run_task_count_;
+    };
+}
@@ -14,14 +14,98 @@
 #include "websocket_impl.h"
 
 namespace nwr {
+    const int Websocket::kSendPrePadding = LWS_SEND_BUFFER_PRE_PADDING;
+    const int Websocket::kSendPostPadding = LWS_SEND_BUFFER_POST_PADDING;
+    
+    Websocket::Options::Options():
+    per_message_deflate(false),
+    buffered_amount_high_watermark(1024 * 1024),
+    buffered_amount_low_watermark(256 * 1024),
+    max_message_size(64 * 1024 * 1024){}
+    
+    Websocket::Stats::Stats():
+    connections(0),
+    sent_bytes(0),
+    sent_wire_bytes(0),
+    received_bytes(0),
+    received_wire_bytes(0),
+    sent_messages(0),
+    received_messages(0),
+    received_fragments(0),
+    max_received_message_size(0),
+    send_queue_depth(0),
+    send_queue_peak(0),
+    total_send_latency(0),
+    max_send_latency(0),
+    connect_duration(0),
+    handshake_duration(0),
+    close_code(0),
+    close_reason(){}
+    
+    double Websocket::Stats::send_compression_ratio() const {
+        if (sent_bytes == 0) { return 1.0; }
+        return static_cast<double>(sent_wire_bytes) / sent_bytes;
+    }
+    double Websocket::Stats::receive_compression_ratio() const {
+        if (received_bytes == 0) { return 1.0; }
+        return static_cast<double>(received_wire_bytes) / received_bytes;
+    }
+    TimeDuration Websocket::Stats::average_send_latency() const {
+        if (sent_messages == 0) { return TimeDuration(0); }
+        return total_send_latency / sent_messages;
+    }
+    
+    Websocket::Stats & Websocket::Stats::operator+= (const Stats & other) {
+        connections += other.connections;
+        sent_bytes += other.sent_bytes;
+        sent_wire_bytes += other.sent_wire_bytes;
+        received_bytes += other.received_bytes;
+        received_wire_bytes += other.received_wire_bytes;
+        sent_messages += other.sent_messages;
+        received_messages += other.received_messages;
+        received_fragments += other.received_fragments;
+        max_received_message_size = std::max(max_received_message_size, other.max_received_message_size);
+        send_queue_depth += other.send_queue_depth;
+        send_queue_peak = std::max(send_queue_peak, other.send_queue_peak);
+        total_send_latency += other.total_send_latency;
+        max_send_latency = std::max(max_send_latency, other.max_send_latency);
+        connect_duration += other.connect_duration;
+        handshake_duration += other.handshake_duration;
+        if (other.close_reason.length() > 0) {
+            close_code = other.close_code;
+            close_reason = other.close_reason;
+        }
+        return *this;
+    }
+    
+    Websocket::Message Websocket::Message::Allocate(Mode mode, int size) {
+        auto buffer = std::make_shared<Data>(kSendPrePadding + size + kSendPostPadding);
+        return Message(mode, BufferSlice(buffer, kSendPrePadding, size));
+    }
+    
+    Websocket::Message Websocket::Message::Allocate(Mode mode, const uint8_t * ptr, int size) {
+        Message message = Allocate(mode, size);
+        std::copy(ptr, ptr + size, message.mutable_ptr());
+        return message;
+    }
+    
+    uint8_t * Websocket::Message::mutable_ptr() {
+        return data.backing()->data() + data.offset();
+    }
+    
+    bool Websocket::Message::has_send_padding() const {
+        if (!data.backing()) {
+            return false;
+        }
+        const int post_size = static_cast<int>(data.backing()->size()) - (data.offset() + data.size());
+        return kSendPrePadding <= data.offset() && kSendPostPadding <= post_size;
+    }
     
     Websocket::Message::Message(const std::string & text):
-    Message(Mode::Text,
-            std::make_shared<Data>(ToData(text))){}
+    Message(Allocate(Mode::Text, AsDataPointer(text), static_cast<int>(text.size()))){}
 
     Websocket::Message::Message(const Data & binary):
-    Message(Mode::Binary,
-            std::make_shared<Data>(binary)){}
+    Message(Allocate(Mode::Binary, binary.data(), static_cast<int>(binary.size()))){}
     
     Websocket::Message::Message():
     Message(Mode::Binary){}
@@ -32,6 +116,9 @@ namespace nwr {
     Websocket::Message::Message(Mode mode, const DataPtr & data):
     mode(mode), data(data){}
     
+    Websocket::Message::Message(Mode mode, const BufferSlice & data):
+    mode(mode), data(data){}
+    
     std::shared_ptr<Websocket> Websocket::Create(const std::string & url,
                                                  const std::string & origin)
     {
@@ -40,9 +127,16 @@ namespace nwr {
     std::shared_ptr<Websocket> Websocket::Create(const std::string & url,
                                                  const std::string & origin,
                                                  const std::shared_ptr<std::string> & protocol)
+    {
+        return Create(url, origin, protocol, Options());
+    }
+    std::shared_ptr<Websocket> Websocket::Create(const std::string & url,
+                                                 const std::string & origin,
+                                                 const std::shared_ptr<std::string> & protocol,
+                                                 const Options & options)
     {
         auto thiz = std::shared_ptr<Websocket>(new Websocket());
-        thiz->impl_->Connect(url, origin, protocol);
+        thiz->impl_->Connect(url, origin, protocol, options);
         return thiz;
     }
 
@@ -73,6 +167,18 @@ namespace nwr {
     void Websocket::set_on_open(const OnOpenFunc & value) {
         impl_->on_open_ = value;
     }
+    Websocket::OnBufferedAmountFunc Websocket::on_buffered_amount_high() {
+        return impl_->on_buffered_amount_high_;
+    }
+    void Websocket::set_on_buffered_amount_high(const OnBufferedAmountFunc & value) {
+        impl_->on_buffered_amount_high_ = value;
+    }
+    Websocket::OnBufferedAmountFunc Websocket::on_buffered_amount_low() {
+        return impl_->on_buffered_amount_low_;
+    }
+    void Websocket::set_on_buffered_amount_low(const OnBufferedAmountFunc & value) {
+        impl_->on_buffered_amount_low_ = value;
+    }
     std::string Websocket::protocol() {
         return impl_->protocol_;
     }
@@ -82,6 +188,12 @@ namespace nwr {
     std::string Websocket::url() {
         return impl_->url_;
     }
+    Websocket::Stats Websocket::stats() {
+        return impl_->stats();
+    }
+    int64_t Websocket::buffered_amount() {
+        return impl_->buffered_amount_;
+    }
 
     void Websocket::Close() {
         impl_->Close();
@@ -94,9 +206,33 @@ namespace nwr {
         Send(Message(message));
     }
     void Websocket::Send(const Message & message) {
-        impl_->Send(message);
+        impl_->Send(Message(message.mode, message.data), false);
+    }
+    void Websocket::Send(Message && message) {
+        impl_->Send(std::move(message), true);
     }
     Websocket::Websocket() {
         impl_ = std::make_shared<WebsocketImpl>(this);
     }
+    
+    std::string ToString(const Websocket::Stats & stats) {
+        std::string str;
+        str += Format("connections: %lld\n", (long long)stats.connections);
+        str += Format("sent: %lld bytes, %lld on wire (%.3f), %lld messages\n",
+                      (long long)stats.sent_bytes, (long long)stats.sent_wire_bytes,
+                      stats.send_compression_ratio(), (long long)stats.sent_messages);
+        str += Format("received: %lld bytes, %lld on wire (%.3f), %lld messages, %lld fragments\n",
+                      (long long)stats.received_bytes, (long long)stats.received_wire_bytes,
+                      stats.receive_compression_ratio(), (long long)stats.received_messages,
+                      (long long)stats.received_fragments);
+        str += Format("max received message: %lld bytes\n", (long long)stats.max_received_message_size);
+        str += Format("send queue: %lld, peak %lld\n",
+                      (long long)stats.send_queue_depth, (long long)stats.send_queue_peak);
+        str += Format("send latency: average %.6f s, max %.6f s\n",
+                      stats.average_send_latency().count(), stats.max_send_latency.count());
+        str += Format("connect: %.3f s, handshake: %.3f s\n",
+                      stats.connect_duration.count(), stats.handshake_duration.count());
+        str += Format("close: %d %s\n", stats.close_code, stats.close_reason.c_str());
+        return str;
+    }
 }
@@ -13,6 +13,7 @@
 #include <functional>
 
 #include "data.h"
+#include "time.h"
 
 namespace nwr {    
     class WebsocketImpl;
@@ -31,24 +32,100 @@ namespace nwr {
                 Binary = 2
             };
             Mode mode;
-            DataPtr data;
+            BufferSlice data;
+            
+            //  a payload of size bytes with the send padding of lws around it,
+            //  so the message is sent in place without a copy when it is moved into Send.
+            //  fill it through mutable_ptr().
+            static Message Allocate(Mode mode, int size);
+            static Message Allocate(Mode mode, const uint8_t * ptr, int size);
+            uint8_t * mutable_ptr();
+            bool has_send_padding() const;
+            
             Message(const std::string & text);
             Message(const Data & binary);
             Message();
             Message(Mode mode);
             Message(Mode mode, const DataPtr & data);
+            Message(Mode mode, const BufferSlice & data);
         };
         
+        struct Options {
+            Options();
+            
+            //  offers permessage-deflate; used only when the server accepts it
+            bool per_message_deflate;
+            
+            //  on_buffered_amount_high is called when buffered_amount reaches high,
+            //  then on_buffered_amount_low once it falls to low.
+            //  both are posted to the owner queue. high must be above low
+            int64_t buffered_amount_high_watermark;
+            int64_t buffered_amount_low_watermark;
+            
+            //  a received message over this is an error and closes the connection; 0 is no limit
+            int64_t max_message_size;
+        };
+        
+        //  metrics of a connection, or the sum of several by operator+=
+        struct Stats {
+            Stats();
+            
+            int64_t connections;
+            
+            //  payload bytes, before and after permessage-deflate
+            int64_t sent_bytes;
+            int64_t sent_wire_bytes;
+            int64_t received_bytes;
+            int64_t received_wire_bytes;
+            
+            //  one frame per message on send; fragments are the receive callbacks of lws
+            int64_t sent_messages;
+            int64_t received_messages;
+            int64_t received_fragments;
+            int64_t max_received_message_size;
+            
+            //  messages given to Send and not yet written
+            int64_t send_queue_depth;
+            int64_t send_queue_peak;
+            
+            //  from Send to lws_write
+            TimeDuration total_send_latency;
+            TimeDuration max_send_latency;
+            
+            //  from Connect to the handshake request, and from it to the response
+            TimeDuration connect_duration;
+            TimeDuration handshake_duration;
+            
+            //  of the last closed connection; close_code is 0 unless the peer sent one
+            int close_code;
+            std::string close_reason;
+            
+            //  wire bytes per payload byte; 1 without compression
+            double send_compression_ratio() const;
+            double receive_compression_ratio() const;
+            TimeDuration average_send_latency() const;
+            
+            Stats & operator+= (const Stats & other);
+        };
+        
+        static const int kSendPrePadding;
+        static const int kSendPostPadding;
+        
         using OnCloseFunc = std::function<void()>;
         using OnErrorFunc = std::function<void(const std::string &)>;
         using OnMessageFunc = std::function<void(const Message &)>;
         using OnOpenFunc = std::function<void()>;
+        using OnBufferedAmountFunc = std::function<void(int64_t)>;
         
         static std::shared_ptr<Websocket> Create(const std::string & url,
                                                  const std::string & origin);
         static std::shared_ptr<Websocket> Create(const std::string & url,
                                                  const std::string & origin,
                                                  const std::shared_ptr<std::string> & protocol);
+        static std::shared_ptr<Websocket> Create(const std::string & url,
+                                                 const std::string & origin,
+                                                 const std::shared_ptr<std::string> & protocol,
+                                                 const Options & options);
         ~Websocket();
         
         OnCloseFunc on_close();
@@ -59,17 +136,32 @@ namespace nwr {
         void set_on_message(const OnMessageFunc & value);
         OnOpenFunc on_open();
         void set_on_open(const OnOpenFunc & value);
+        OnBufferedAmountFunc on_buffered_amount_high();
+        void set_on_buffered_amount_high(const OnBufferedAmountFunc & value);
+        OnBufferedAmountFunc on_buffered_amount_low();
+        void set_on_buffered_amount_low(const OnBufferedAmountFunc & value);
         std::string protocol();
         ReadyState ready_state();
         std::string url();
+        //  owner thread only
+        Stats stats();
+        //  payload bytes given to Send and not yet written to the socket
+        int64_t buffered_amount();
         
         void Close();
         void Send(const std::string & message);
         void Send(const Data & message);
+        //  the payload is copied when it is written, its backing is never written to
         void Send(const Message & message);
+        //  takes the backing of message. lws writes into it, so no other slice of it
+        //  may be read after this. sent in place if it has the send padding
+        void Send(Message && message);
     private:
         Websocket();
         
         std::shared_ptr<WebsocketImpl> impl_;
     };
+    
+    //  one line per metric, for logs
+    std::string ToString(const Websocket::Stats & stats);
 }
@@ -8,17 +8,47 @@
 
 #include "websocket_impl.h"
 
+#include <tuple>
+
 #include "env.h"
 #include "string.h"
 #include "url.h"
 #include "task_queue.h"
+#include "task_instrument.h"
 
 namespace nwr {
     WebsocketImpl::WebsocketImpl(Websocket * owner) {
         owner_ = owner;
         queue_ = TaskQueue::current_queue();
         ready_state_ = Websocket::ReadyState::Connecting;
-        context_ = nullptr;
+        ws_client_ = nullptr;
+        connection_id_ = nullptr;
+        writable_requested_ = false;
+        buffered_amount_ = 0;
+        buffered_amount_high_watermark_ = 0;
+        buffered_amount_low_watermark_ = 0;
+        congested_ = false;
+        sent_bytes_ = 0;
+        received_bytes_ = 0;
+        deflate_input_bytes_ = 0;
+        deflate_output_bytes_ = 0;
+        inflate_input_bytes_ = 0;
+        inflate_output_bytes_ = 0;
+        sent_messages_ = 0;
+        received_messages_ = 0;
+        received_fragments_ = 0;
+        max_received_message_size_ = 0;
+        total_send_latency_us_ = 0;
+        max_send_latency_us_ = 0;
+        connect_duration_us_ = 0;
+        handshake_duration_us_ = 0;
+        close_code_ = 0;
+        send_queue_depth_ = 0;
+        send_queue_peak_ = 0;
+        receiving_mode_ = Websocket::Message::Mode::Binary;
+        max_message_size_ = 0;
+        receive_buffer_pool_ = std::make_shared<WebsocketBufferPool>(kReceiveBufferPoolSize,
+                                                                     kReceiveBufferPoolMaxCapacity);
     }
     WebsocketImpl::~WebsocketImpl() {
         if (!is_closed()) {
@@ -28,7 +58,8 @@ namespace nwr {
     
     void WebsocketImpl::Connect(const std::string & url,
                                 const std::string & origin,
-                                const std::shared_ptr<std::string> & protocol)
+                                const std::shared_ptr<std::string> & protocol,
+                                const Websocket::Options & options)
     {
         auto url_parts = ParseUrl(url);
         auto scheme = url_parts.scheme;
@@ -47,30 +78,43 @@ namespace nwr {
             }
         }
         url_ = url;
+        buffered_amount_high_watermark_ = options.buffered_amount_high_watermark;
+        buffered_amount_low_watermark_ = options.buffered_amount_low_watermark;
+        max_message_size_ = options.max_message_size;
+        if (buffered_amount_high_watermark_ <= buffered_amount_low_watermark_) {
+            Fatal(Format("buffered_amount_high_watermark(%lld) <= buffered_amount_low_watermark(%lld)",
+                         (long long)buffered_amount_high_watermark_,
+                         (long long)buffered_amount_low_watermark_));
+        }
         
         std::string path = url_parts.path;
         if (url_parts.query.size() > 0) {
             path += "?" + QueryStringEncode(url_parts.query);
         }
         
-        context_ = new WebsocketContext(protocol, &WebsocketImpl::LwsCallbackHandlerStatic);
+        context_ = WebsocketContext::Shared(protocol, options.per_message_deflate);
+        connect_start_time_ = Clock::now();
         
-        context_->thread()->PostTask([this, url_parts, is_ssl, origin, path]{
+        //  the task must not own the context, it may be the last owner on the service thread
+        WebsocketContext * context = context_.get();
+        context->thread()->PostTask([this, context, url_parts, is_ssl, origin, path]{
+            connection_id_ = context->Attach(this);
+            
             lws_client_connect_info info = { 0 };
-            info.context = context_->context();
+            info.context = context->context();
             info.address = url_parts.hostname.c_str();
             info.port = url_parts.port || -1;
             info.ssl_connection = is_ssl ? 2 : 0;
             info.path = path.c_str();
             info.host = url_parts.hostname.c_str();
             info.origin = origin.c_str();
-            if (context_->protocol()) {
-                info.protocol = context_->protocol()->c_str();
+            if (context->protocol()) {
+                info.protocol = context->protocol()->c_str();
             } else {
                 info.protocol = nullptr;
             }
             info.ietf_version_or_minus_one = -1;
-            info.userdata = this;
+            info.userdata = connection_id_;
             
             ws_client_ = lws_client_connect_via_info(&info);
         });
@@ -79,8 +123,27 @@ namespace nwr {
     void WebsocketImpl::Close() {
         if (is_closed()) { return; }
         
+        if (close_reason_.length() == 0) {
+            close_reason_ = "closed locally";
+        }
+        
         if (context_) {
-            delete context_;
+            //  not waited for, the service thread may be waiting on this one.
+            //  the task holds this until it runs, and the context is destroyed
+            //  only after its thread runs the tasks posted before
+            WebsocketContext * context = context_.get();
+            context->thread()->PostTask([context, thiz = shared_from_this()]() mutable {
+                //  after this no callback reaches this connection
+                context->Detach(thiz->connection_id_);
+                if (thiz->ws_client_) {
+                    //  the callback closes a detached connection on its next writable
+                    lws_callback_on_writable(thiz->ws_client_);
+                    thiz->ws_client_ = nullptr;
+                }
+                //  released on the owner thread, with the callbacks it holds
+                auto queue = thiz->queue_;
+                queue->PostTask(Task(NWR_HERE, [thiz = std::move(thiz)]{}));
+            });
             context_ = nullptr;
         }
         
@@ -88,20 +151,63 @@ namespace nwr {
         FuncCall(on_close_);
     }
     
-    void WebsocketImpl::Send(const Websocket::Message & message) {
+    void WebsocketImpl::Send(Websocket::Message && message, bool owned) {
         if (ready_state_ != Websocket::ReadyState::Open) {
             Fatal(Format("ready_state(%d) != Open", ready_state_));
         }
         
+        //  counted before the push, so the write never makes it negative
+        const int64_t amount = buffered_amount_ += message.data.size();
+        const int64_t depth = ++send_queue_depth_;
+        send_queue_peak_ = std::max(send_queue_peak_, depth);
+        
+        //  posted like the low one, so a listener does not run inside Send.
+        //  posted before the push, so it reaches the owner before the low one of any write
+        if (!congested_ && amount >= buffered_amount_high_watermark_) {
+            congested_ = true;
+            queue_->PostTask(Task(NWR_HERE, [thiz = shared_from_this(), amount]{
+                thiz->HandleBufferedAmountHigh(amount);
+            }));
+        }
+        
         {
             std::lock_guard<std::mutex> lk(mutex_);
-            sending_queue_.push_back(message);
+            sending_queue_.push_back(PendingMessage { std::move(message), owned, Clock::now() });
+        }
+        //  one wakeup until the writable callback takes the queue
+        if (!writable_requested_.exchange(true)) {
             context_->thread()->PostTask([this] {
-                lws_callback_on_writable(this->ws_client_);
+                if (this->ws_client_) {
+                    lws_callback_on_writable(this->ws_client_);
+                }
             });
         }
     }
     
+    Websocket::Stats WebsocketImpl::stats() {
+        using Micro = std::chrono::microseconds;
+        
+        Websocket::Stats stats;
+        stats.connections = 1;
+        stats.sent_bytes = sent_bytes_;
+        stats.sent_wire_bytes = stats.sent_bytes - deflate_input_bytes_ + deflate_output_bytes_;
+        stats.received_bytes = received_bytes_;
+        stats.received_wire_bytes = stats.received_bytes - inflate_output_bytes_ + inflate_input_bytes_;
+        stats.sent_messages = sent_messages_;
+        stats.received_messages = received_messages_;
+        stats.received_fragments = received_fragments_;
+        stats.max_received_message_size = max_received_message_size_;
+        stats.send_queue_depth = send_queue_depth_;
+        stats.send_queue_peak = send_queue_peak_;
+        stats.total_send_latency = Micro(total_send_latency_us_.load());
+        stats.max_send_latency = Micro(max_send_latency_us_.load());
+        stats.connect_duration = Micro(connect_duration_us_.load());
+        stats.handshake_duration = Micro(handshake_duration_us_.load());
+        stats.close_code = close_code_;
+        stats.close_reason = close_reason_;
+        return stats;
+    }
+    
     int WebsocketImpl::LwsCallbackHandlerStatic(struct lws * wsi,
                                                 enum lws_callback_reasons reason,
                                                 void * user, void * in, size_t len)
@@ -114,7 +220,19 @@ namespace nwr {
             }
             return 0;
         }
-        auto * thiz = static_cast<WebsocketImpl *>(user);
+        auto * context = static_cast<WebsocketContext *>(lws_context_user(lws_get_context(wsi)));
+        auto * thiz = context->Find(user);
+        if (!thiz) {
+            //  closed by its owner, drop the connection
+            switch (reason) {
+                case LWS_CALLBACK_CLIENT_ESTABLISHED:
+                case LWS_CALLBACK_CLIENT_RECEIVE:
+                case LWS_CALLBACK_CLIENT_WRITEABLE:
+                    return -1;
+                default:
+                    return 0;
+            }
+        }
         return thiz->LwsCallbackHandler(wsi, reason, user, in, len);
     }
     
@@ -124,38 +242,54 @@ namespace nwr {
     {
 //        printf("[WebsocketImpl::LwsCallbackHandler] reason=%d\n", reason);
         switch (reason) {
+            case LWS_CALLBACK_CLIENT_APPEND_HANDSHAKE_HEADER: {
+                handshake_start_time_ = Clock::now();
+                connect_duration_us_ = std::chrono::duration_cast<std::chrono::microseconds>
+                (handshake_start_time_ - connect_start_time_).count();
+                break;
+            }
             case LWS_CALLBACK_CLIENT_ESTABLISHED: {
+                handshake_duration_us_ = std::chrono::duration_cast<std::chrono::microseconds>
+                (Clock::now() - handshake_start_time_).count();
                 protocol_ = lws_get_protocol(wsi)->name;
                 
                 {
                     auto thiz = shared_from_this();
-                    queue_->PostTask([thiz]{
+                    queue_->PostTask(Task(NWR_HERE, [thiz]{
                         thiz->HandleConnected();
-                    });
+                    }));
                 }
                 break;
             }
             case LWS_CALLBACK_CLIENT_CONNECTION_ERROR: {
+                ws_client_ = nullptr;
+                
                 std::string message("connection error");
                 if (in) {
                     message = Format("%s: %.*s", message.c_str(), len, (char *)in);
                 }
                 
-                {
-                    auto thiz = shared_from_this();
-                    queue_->PostTask([thiz, message]{
-                        thiz->HandleError(message);
-                    });
-                }
+                queue_->PostTask(Task(NWR_HERE, [thiz = shared_from_this(), message = std::move(message)]{
+                    thiz->HandleError(message);
+                }));
                 
                 break;
             }
+            case LWS_CALLBACK_WS_PEER_INITIATED_CLOSE: {
+                if (in && len >= 2) {
+                    const uint8_t * code = static_cast<const uint8_t *>(in);
+                    close_code_ = (code[0] << 8) | code[1];
+                }
+                break;
+            }
             case LWS_CALLBACK_CLOSED: {
+                ws_client_ = nullptr;
+                
                 {
                     auto thiz = shared_from_this();
-                    queue_->PostTask([thiz] {
+                    queue_->PostTask(Task(NWR_HERE, [thiz] {
                         thiz->HandleClosed();
-                    });
+                    }));
                 }
                 
                 break;
@@ -163,85 +297,110 @@ namespace nwr {
             case LWS_CALLBACK_CLIENT_RECEIVE: {
                 uint8_t * data = static_cast<uint8_t *>(in);
                 const int read_len = static_cast<int>(len);
-                const int rest_len = static_cast<int>(lws_remaining_packet_payload(ws_client_));
+                const int rest_len = static_cast<int>(lws_remaining_packet_payload(wsi));
                 
-                if (!receiving_message_) {
-                    Websocket::Message::Mode mode;
-                    if (lws_frame_is_binary(ws_client_)) {
-                        mode = Websocket::Message::Mode::Binary;
+                if (!receiving_data_) {
+                    if (lws_frame_is_binary(wsi)) {
+                        receiving_mode_ = Websocket::Message::Mode::Binary;
                     } else {
-                        mode = Websocket::Message::Mode::Text;
+                        receiving_mode_ = Websocket::Message::Mode::Text;
                     }
                     
-                    receiving_message_ = std::make_shared<Websocket::Message>(mode, std::make_shared<Data>());
+                    receiving_data_ = receive_buffer_pool_->Take();
                 }
                 
-                receiving_message_->data->insert(receiving_message_->data->end(),
-                                                 data, data + read_len);
+                //  the rest of the frame is known, so an oversize one is rejected at its first fragment
+                const size_t needed = receiving_data_->size() + read_len + rest_len;
+                if (max_message_size_ > 0 && static_cast<int64_t>(needed) > max_message_size_) {
+                    receiving_data_ = nullptr;
+                    
+                    auto message = Format("message too large: %lld > %lld",
+                                          (long long)needed, (long long)max_message_size_);
+                    queue_->PostTask(Task(NWR_HERE, [thiz = shared_from_this(), message = std::move(message)]{
+                        thiz->HandleError(message);
+                    }));
+                    return -1;
+                }
+                if (receiving_data_->capacity() < needed) {
+                    //  doubled for messages of many frames
+                    receiving_data_->reserve(std::max(needed, receiving_data_->capacity() * 2));
+                }
+                
+                //  the only copy of the received bytes;
+                //  the layers above take slices of this buffer
+                receiving_data_->insert(receiving_data_->end(), data, data + read_len);
+                received_bytes_ += read_len;
+                received_fragments_ += 1;
                 
-                if (rest_len > 0) {
+                if (rest_len > 0 || !lws_is_final_fragment(wsi)) {
                     break;
                 }
                 
-                auto message = receiving_message_;
-                receiving_message_ = nullptr;
+                Websocket::Message message(receiving_mode_, receiving_data_);
+                receiving_data_ = nullptr;
                 
-                {
-                    auto thiz = shared_from_this();
-                    queue_->PostTask([thiz, message]{
-                        thiz->HandleMessage(*message);
-                    });
+                received_messages_ += 1;
+                const int64_t message_size = message.data.size();
+                if (max_received_message_size_ < message_size) {
+                    max_received_message_size_ = message_size;
                 }
                 
+                //  moved all the way, so the buffer is not shared on its way to the owner
+                queue_->PostTask(Task(NWR_HERE, [thiz = shared_from_this(), message = std::move(message)]{
+                    thiz->HandleMessage(message);
+                }));
+                
                 break;
             }
             case LWS_CALLBACK_CLIENT_WRITEABLE: {
-                Websocket::Message message;
-                
-                {
-                    std::lock_guard<std::mutex> lk(mutex_);
-                    if (sending_queue_.size() == 0) {
-                        break;
+                //  drain as many frames as the socket takes
+                while (true) {
+                    if (writing_queue_.size() == 0) {
+                        //  cleared before the swap, so a message pushed after it requests again
+                        writable_requested_ = false;
+                        {
+                            std::lock_guard<std::mutex> lk(mutex_);
+                            writing_queue_.swap(sending_queue_);
+                        }
+                        if (writing_queue_.size() == 0) {
+                            break;
+                        }
                     }
-                    message = sending_queue_.front();
-                    sending_queue_.pop_front();
-                }
-                
-                const int data_len = static_cast<int>(message.data->size());
-                const int buf_len = LWS_SEND_BUFFER_PRE_PADDING + data_len + LWS_SEND_BUFFER_POST_PADDING;
-                Data buf(buf_len);
-                std::copy(message.data->begin(), message.data->begin() + data_len,
-                          buf.begin() + LWS_SEND_BUFFER_PRE_PADDING);
-                
-                lws_write_protocol write_protocol;
-                switch (message.mode) {
-                    case Websocket::Message::Mode::Text:
-                        write_protocol = LWS_WRITE_TEXT;
-                        break;
-                    case Websocket::Message::Mode::Binary:
-                        write_protocol = LWS_WRITE_BINARY;
+                    if (lws_send_pipe_choked(wsi)) {
+                        lws_callback_on_writable(wsi);
                         break;
-                    default:
+                    }
+                    
+                    PendingMessage pending = std::move(writing_queue_.front());
+                    writing_queue_.pop_front();
+                    send_queue_depth_ -= 1;
+                    
+                    const int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>
+                    (Clock::now() - pending.send_time).count();
+                    total_send_latency_us_ += latency_us;
+                    if (max_send_latency_us_ < latency_us) {
+                        max_send_latency_us_ = latency_us;
+                    }
+                    
+                    if (!WriteMessage(wsi, pending)) {
+                        queue_->PostTask(Task(NWR_HERE, [thiz = shared_from_this()]{
+                            thiz->HandleError(Format("lws_write failed"));
+                        }));
                         break;
+                    }
+                    
+                    const int64_t size = pending.message.data.size();
+                    const int64_t amount = buffered_amount_ -= size;
+                    //  only the write crossing the low watermark wakes the owner
+                    if (amount <= buffered_amount_low_watermark_ &&
+                        buffered_amount_low_watermark_ < amount + size)
+                    {
+                        queue_->PostTask(Task(NWR_HERE, [thiz = shared_from_this()]{
+                            thiz->HandleBufferedAmountLow();
+                        }));
+                    }
                 }
                 
-                const int wrote_len = lws_write(ws_client_,
-                                                &buf[0] + LWS_SEND_BUFFER_PRE_PADDING,
-                                                data_len,
-                                                write_protocol);
-                if (wrote_len == -1) {
-                    auto thiz = shared_from_this();
-                    queue_->PostTask([thiz]{
-                        thiz->HandleError(Format("lws_write failed"));
-                    });
-                    break;
-                }
-                
-                if (wrote_len < data_len) {
-                    Fatal(Format("lws_write failed: buf=%d, wrote=%d", buf_len, wrote_len));
-                }
-                lws_callback_on_writable(ws_client_);
-                
                 break;
             }
             default:
@@ -250,15 +409,65 @@ namespace nwr {
         return 0;
     }
     
+    bool WebsocketImpl::WriteMessage(lws * wsi, PendingMessage & pending) {
+        Websocket::Message & message = pending.message;
+        const int data_len = message.data.size();
+        const int buf_len = LWS_SEND_BUFFER_PRE_PADDING + data_len + LWS_SEND_BUFFER_POST_PADDING;
+        
+        //  lws writes the frame header into the padding and masks the payload in place,
+        //  so only a buffer handed over by Send is sent as it is
+        uint8_t * payload;
+        Data buf;
+        if (pending.owned && message.has_send_padding()) {
+            payload = message.mutable_ptr();
+        } else {
+            buf.resize(buf_len);
+            std::copy(message.data.ptr(), message.data.ptr() + data_len,
+                      buf.begin() + LWS_SEND_BUFFER_PRE_PADDING);
+            payload = &buf[0] + LWS_SEND_BUFFER_PRE_PADDING;
+        }
+        
+        lws_write_protocol write_protocol;
+        switch (message.mode) {
+            case Websocket::Message::Mode::Text:
+                write_protocol = LWS_WRITE_TEXT;
+                break;
+            case Websocket::Message::Mode::Binary:
+                write_protocol = LWS_WRITE_BINARY;
+                break;
+            default:
+                break;
+        }
+        
+        const int wrote_len = lws_write(wsi,
+                                        payload,
+                                        data_len,
+                                        write_protocol);
+        if (wrote_len == -1) {
+            return false;
+        }
+        
+        if (wrote_len < data_len) {
+            Fatal(Format("lws_write failed: buf=%d, wrote=%d", buf_len, wrote_len));
+        }
+        sent_bytes_ += data_len;
+        sent_messages_ += 1;
+        return true;
+    }
+    
     void WebsocketImpl::HandleError(const std::string & message) {
         if (is_closed()) { return; }
         
+        close_reason_ = Format("error: %s", message.c_str());
         FuncCall(on_error_, message);
         
         Close();
     }
     
     void WebsocketImpl::HandleClosed() {
+        if (!is_closed()) {
+            close_reason_ = "closed by peer";
+        }
         Close();
     }
     
@@ -275,10 +484,56 @@ namespace nwr {
         FuncCall(on_message_, message);
     }
     
+    void WebsocketImpl::HandleBufferedAmountHigh(int64_t amount) {
+        if (is_closed()) { return; }
+        
+        FuncCall(on_buffered_amount_high_, amount);
+    }
+    
+    void WebsocketImpl::HandleBufferedAmountLow() {
+        if (is_closed()) { return; }
+        if (!congested_) { return; }
+        
+        //  Send may have refilled it since the post; a later write crosses again
+        const int64_t amount = buffered_amount_;
+        if (amount > buffered_amount_low_watermark_) { return; }
+        
+        congested_ = false;
+        FuncCall(on_buffered_amount_low_, amount);
+    }
+    
     
     
+    std::shared_ptr<WebsocketContext> WebsocketContext::Shared(const std::shared_ptr<std::string> & protocol,
+                                                               bool per_message_deflate)
+    {
+        //  extensions are set per context, so deflate gets a context of its own
+        using Key = std::tuple<bool, std::string, bool>;
+        static std::mutex mutex;
+        static std::map<Key, std::weak_ptr<WebsocketContext>> contexts;
+        
+        std::lock_guard<std::mutex> lk(mutex);
+        for (auto iter = contexts.begin(); iter != contexts.end(); ) {
+            if (iter->second.expired()) {
+                iter = contexts.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+        auto & entry = contexts[Key(protocol != nullptr, protocol ? *protocol : std::string(), per_message_deflate)];
+        auto context = entry.lock();
+        if (!context) {
+            context = std::make_shared<WebsocketContext>(protocol, per_message_deflate,
+                                                         &WebsocketImpl::LwsCallbackHandlerStatic);
+            entry = context;
+        }
+        return context;
+    }
+    
     WebsocketContext::WebsocketContext(const std::shared_ptr<std::string> & protocol,
-                                       lws_callback_function callback)
+                                       bool per_message_deflate,
+                                       lws_callback_function callback):
+    next_connection_id_(1)
     {
         protocol_ = protocol;
         
@@ -299,11 +554,23 @@ namespace nwr {
             nullptr
         };
         
+        memset(context_extensions_, 0, sizeof(context_extensions_));
+        
+        context_extensions_[0] = {
+            "permessage-deflate",
+            &WebsocketContext::DeflateExtensionCallback,
+            "permessage-deflate; client_max_window_bits"
+        };
+        
         lws_context_creation_info info = { 0 };
         info.port = CONTEXT_PORT_NO_LISTEN;
         info.protocols = context_protocols_;
+        if (per_message_deflate) {
+            info.extensions = context_extensions_;
+        }
         info.gid = -1;
         info.uid = -1;
+        info.user = this;
         
         context_ = lws_create_context(&info);
         if (!context_) {
@@ -320,19 +587,129 @@ namespace nwr {
         lws_context_destroy(context_);
     }
     
+    int WebsocketContext::DeflateExtensionCallback(lws_context * context,
+                                                   const lws_extension * ext, lws * wsi,
+                                                   lws_extension_callback_reasons reason,
+                                                   void * user, void * in, size_t len)
+    {
+        if (reason != LWS_EXT_CB_PAYLOAD_TX && reason != LWS_EXT_CB_PAYLOAD_RX) {
+            return lws_extension_callback_pm_deflate(context, ext, wsi, reason, user, in, len);
+        }
+        
+        //  the tokens are replaced by the (de)compressed payload
+        auto * tokens = static_cast<lws_tokens *>(in);
+        const int input_len = tokens->token_len;
+        const int result = lws_extension_callback_pm_deflate(context, ext, wsi, reason, user, in, len);
+        const int output_len = tokens->token_len;
+        
+        auto * thiz = static_cast<WebsocketContext *>(lws_context_user(context));
+        WebsocketImpl * impl = thiz->Find(lws_wsi_user(wsi));
+        if (impl) {
+            if (reason == LWS_EXT_CB_PAYLOAD_TX) {
+                impl->deflate_input_bytes_ += input_len;
+                impl->deflate_output_bytes_ += output_len;
+            } else {
+                impl->inflate_input_bytes_ += input_len;
+                impl->inflate_output_bytes_ += output_len;
+            }
+        }
+        return result;
+    }
+    
+    void * WebsocketContext::Attach(WebsocketImpl * impl) {
+        void * connection_id = reinterpret_cast<void *>(next_connection_id_);
+        next_connection_id_ += 1;
+        connections_[connection_id] = impl;
+        return connection_id;
+    }
+    void WebsocketContext::Detach(void * connection_id) {
+        connections_.erase(connection_id);
+    }
+    WebsocketImpl * WebsocketContext::Find(void * connection_id) {
+        auto iter = connections_.find(connection_id);
+        if (iter == connections_.end()) {
+            return nullptr;
+        }
+        return iter->second;
+    }
+    
+    
+    
+    WebsocketBufferPool::WebsocketBufferPool(size_t max_count, size_t max_capacity):
+    max_count_(max_count),
+    max_capacity_(max_capacity)
+    {}
+    
+    WebsocketBufferPool::~WebsocketBufferPool() {
+        for (auto buffer : buffers_) {
+            delete buffer;
+        }
+    }
+    
+    DataPtr WebsocketBufferPool::Take() {
+        Data * buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (buffers_.size() > 0) {
+                buffer = buffers_.back();
+                buffers_.pop_back();
+            }
+        }
+        if (!buffer) {
+            buffer = new Data();
+        }
+        //  the deleter holds the pool, so a message may outlive its connection
+        return DataPtr(buffer, [pool = shared_from_this()](Data * buffer) {
+            pool->Return(buffer);
+        });
+    }
+    
+    void WebsocketBufferPool::Return(Data * buffer) {
+        if (buffer->capacity() <= max_capacity_) {
+            buffer->clear();
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (buffers_.size() < max_count_) {
+                buffers_.push_back(buffer);
+                return;
+            }
+        }
+        delete buffer;
+    }
+    
     
     
     WebsocketThread::WebsocketThread(lws_context * context):
-    context_(context){
-        thread_ = std::thread(std::bind(&WebsocketThread::ThreadMain, this));
+    context_(context),
+    wakeup_pending_(false)
+    {
         do_quit_ = false;
+        thread_ = std::thread(std::bind(&WebsocketThread::ThreadMain, this));
+    }
+    void WebsocketThread::PostTask(Task && task) {
+        tasks_.Push(TaskInstrument::shared().Wrap("WebsocketThread", std::move(task)));
+        if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+            lws_cancel_service(context_);
+        }
     }
-    void WebsocketThread::PostTask(const Task & task) {
-        PushTask(task);
-        lws_cancel_service(context_);
+    void WebsocketThread::PostTaskSync(Task && task) {
+        if (std::this_thread::get_id() == thread_.get_id()) {
+            task();
+            return;
+        }
+        std::mutex mutex;
+        std::condition_variable done_cond;
+        bool done = false;
+        PostTask([&]{
+            task();
+            std::lock_guard<std::mutex> lk(mutex);
+            done = true;
+            done_cond.notify_one();
+        });
+        std::unique_lock<std::mutex> lk(mutex);
+        done_cond.wait(lk, [&]{ return done; });
     }
     void WebsocketThread::Quit() {
-        PushTask([this] {
+        PostTask([this] {
             this->do_quit_ = true;
         });
         thread_.join();
@@ -341,26 +718,15 @@ namespace nwr {
         while (!do_quit_) {
             lws_service(context_, 1000);
             
-            while (true) {
-                Task task;
-                if (!PopTask(task)) {
-                    break;
-                }
+            //  cleared before draining, so a task pushed after the drain wakes the thread again.
+            //  an exchange, so a post that saw the flag set is visible to the drain.
+            wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+            
+            Task task;
+            while (tasks_.Pop(task)) {
                 task();
+                task = nullptr;
             }
         }
     }
-    void WebsocketThread::PushTask(const Task & task) {
-        std::lock_guard<std::mutex> lk(mutex_);
-        tasks_.push_back(task);
-    }
-    bool WebsocketThread::PopTask(Task & dest_task) {
-        std::lock_guard<std::mutex> lk(mutex_);
-        if (tasks_.size() == 0) {
-            return false;
-        }
-        dest_task = tasks_.front();
-        tasks_.pop_front();
-        return true;
-    }
 }
\ No newline at end of file
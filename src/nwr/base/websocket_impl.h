@@ -14,6 +14,11 @@
 #include <deque>
 #include <algorithm>
 #include <mutex>
+#include <condition_variable>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <vector>
 
 extern "C" {
 #include <libwebsockets.h>
@@ -22,6 +27,7 @@ extern "C" {
 #include "data.h"
 #include "func.h"
 #include "looper.h"
+#include "mpsc_queue.h"
 
 #include "websocket.h"
 
@@ -29,9 +35,22 @@ namespace nwr {
     class TaskQueue;
     class WebsocketContext;
     class WebsocketThread;
+    class WebsocketBufferPool;
     
     class WebsocketImpl: public std::enable_shared_from_this<WebsocketImpl> {
     public:
+        static constexpr int kReceiveBufferPoolSize = 4;
+        //  larger buffers are freed with their message
+        static constexpr size_t kReceiveBufferPoolMaxCapacity = 256 * 1024;
+        
+        using Clock = std::chrono::steady_clock;
+        struct PendingMessage {
+            Websocket::Message message;
+            //  given by Send(Message &&), so lws may write into its backing
+            bool owned;
+            Clock::time_point send_time;
+        };
+        
         WebsocketImpl(Websocket * owner);
         ~WebsocketImpl();
         
@@ -39,9 +58,11 @@ namespace nwr {
         
         void Connect(const std::string & url,
                      const std::string & origin,
-                     const std::shared_ptr<std::string> & protocol);
+                     const std::shared_ptr<std::string> & protocol,
+                     const Websocket::Options & options);
         void Close();
-        void Send(const Websocket::Message & message);
+        void Send(Websocket::Message && message, bool owned);
+        Websocket::Stats stats();
         
         static int LwsCallbackHandlerStatic(struct lws * wsi,
                                             enum lws_callback_reasons reason,
@@ -49,10 +70,13 @@ namespace nwr {
         int LwsCallbackHandler(struct lws * wsi,
                                enum lws_callback_reasons reason,
                                void * user, void * in, size_t len);
+        bool WriteMessage(lws * wsi, PendingMessage & pending);
         void HandleError(const std::string & message);
         void HandleClosed();
         void HandleConnected();
         void HandleMessage(const Websocket::Message & message);
+        void HandleBufferedAmountHigh(int64_t amount);
+        void HandleBufferedAmountLow();
         
         Websocket * owner_;
         
@@ -60,6 +84,8 @@ namespace nwr {
         Websocket::OnErrorFunc on_error_;
         Websocket::OnMessageFunc on_message_;
         Websocket::OnOpenFunc on_open_;
+        Websocket::OnBufferedAmountFunc on_buffered_amount_high_;
+        Websocket::OnBufferedAmountFunc on_buffered_amount_low_;
         
         std::string protocol_;
         Websocket::ReadyState ready_state_;
@@ -67,18 +93,69 @@ namespace nwr {
         
         std::shared_ptr<TaskQueue> queue_;
         
-        WebsocketContext * context_;
+        std::shared_ptr<WebsocketContext> context_;
+        //  below are touched only on the service thread
         lws * ws_client_;
+        void * connection_id_;
         
         std::mutex mutex_;
-        std::deque<Websocket::Message> sending_queue_;
-        
-        std::shared_ptr<Websocket::Message> receiving_message_;
+        std::deque<PendingMessage> sending_queue_;
+        std::atomic<bool> writable_requested_;
+        //  taken from sending_queue_ at once, service thread only
+        std::deque<PendingMessage> writing_queue_;
+        
+        //  added by Send, subtracted on the service thread after each write
+        std::atomic<int64_t> buffered_amount_;
+        int64_t buffered_amount_high_watermark_;
+        int64_t buffered_amount_low_watermark_;
+        //  between on_buffered_amount_high and on_buffered_amount_low, owner thread only
+        bool congested_;
+        
+        //  service thread only
+        Websocket::Message::Mode receiving_mode_;
+        DataPtr receiving_data_;
+        int64_t max_message_size_;
+        //  buffers of received messages; reused once the layers above release them
+        std::shared_ptr<WebsocketBufferPool> receive_buffer_pool_;
+        
+        //  written on the service thread
+        std::atomic<int64_t> sent_bytes_;
+        std::atomic<int64_t> received_bytes_;
+        std::atomic<int64_t> deflate_input_bytes_;
+        std::atomic<int64_t> deflate_output_bytes_;
+        std::atomic<int64_t> inflate_input_bytes_;
+        std::atomic<int64_t> inflate_output_bytes_;
+        std::atomic<int64_t> sent_messages_;
+        std::atomic<int64_t> received_messages_;
+        std::atomic<int64_t> received_fragments_;
+        std::atomic<int64_t> max_received_message_size_;
+        std::atomic<int64_t> total_send_latency_us_;
+        std::atomic<int64_t> max_send_latency_us_;
+        std::atomic<int64_t> connect_duration_us_;
+        std::atomic<int64_t> handshake_duration_us_;
+        std::atomic<int> close_code_;
+        //  set on the owner thread before Connect posts, read on the service thread
+        Clock::time_point connect_start_time_;
+        //  service thread only
+        Clock::time_point handshake_start_time_;
+        
+        //  added by Send, subtracted after each write like buffered_amount_
+        std::atomic<int64_t> send_queue_depth_;
+        //  owner thread only
+        int64_t send_queue_peak_;
+        std::string close_reason_;
     };
     
+    //  one lws_context and service thread, shared by every connection of the same protocol.
+    //  a connection is routed by the id given as its lws userdata.
     class WebsocketContext {
     public:
+        //  existing context for the protocol, or a new one
+        static std::shared_ptr<WebsocketContext> Shared(const std::shared_ptr<std::string> & protocol,
+                                                        bool per_message_deflate);
+        
         WebsocketContext(const std::shared_ptr<std::string> & protocol,
+                         bool per_message_deflate,
                          lws_callback_function callback);
         ~WebsocketContext();
         
@@ -86,14 +163,48 @@ namespace nwr {
         WebsocketThread * thread() { return thread_; }
         std::shared_ptr<std::string> protocol() { return protocol_; }
         
+        //  service thread only
+        void * Attach(WebsocketImpl * impl);
+        void Detach(void * connection_id);
+        WebsocketImpl * Find(void * connection_id);
     private:
+        //  wraps the permessage-deflate of lws to count bytes
+        static int DeflateExtensionCallback(lws_context * context,
+                                            const lws_extension * ext, lws * wsi,
+                                            lws_extension_callback_reasons reason,
+                                            void * user, void * in, size_t len);
+        
         std::shared_ptr<std::string> protocol_;
         std::string inner_protocol_;
         lws_protocols context_protocols_[2];
+        lws_extension context_extensions_[2];
         
         lws_context * context_;
         
         WebsocketThread * thread_;
+        
+        std::map<void *, WebsocketImpl *> connections_;
+        uintptr_t next_connection_id_;
+    };
+    
+    //  buffers handed back by the deleter of their DataPtr, from any thread.
+    //  the lock orders the last reads of a released buffer before it is reused
+    class WebsocketBufferPool: public std::enable_shared_from_this<WebsocketBufferPool> {
+    public:
+        //  keeps up to max_count buffers, of up to max_capacity bytes each
+        WebsocketBufferPool(size_t max_count, size_t max_capacity);
+        ~WebsocketBufferPool();
+        
+        //  an empty buffer, which comes back here when its last owner releases it
+        DataPtr Take();
+    private:
+        void Return(Data * buffer);
+        
+        size_t max_count_;
+        size_t max_capacity_;
+        
+        std::mutex mutex_;
+        std::vector<Data *> buffers_;
     };
     
     class WebsocketThread: public Looper {
@@ -103,18 +214,19 @@ namespace nwr {
         
         lws_context * context() { return context_; }
         
-        virtual void PostTask(const Task & task);
+        virtual void PostTask(Task && task);
+        //  waits for the task to finish. runs it in place on the service thread.
+        void PostTaskSync(Task && task);
         
         virtual void Quit();
     private:
         void ThreadMain();
-        void PushTask(const Task & task);
-        bool PopTask(Task & dest_task);
         lws_context * context_;
         
         std::thread thread_;
-        std::mutex mutex_;
-        std::deque<Task> tasks_;
+        MpscQueue<Task> tasks_;
+        //  set by the first post after the thread woke up, so a burst of posts wakes it once
+        std::atomic<bool> wakeup_pending_;
         
         bool do_quit_;
     };
@@ -0,0 +1,120 @@
+//
+//  worker_pool.cpp
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+#include "task_instrument.h"
+
+namespace nwr {
+    namespace {
+        //  the pool and the index of the worker running on this thread
+        thread_local WorkerPool * current_pool = nullptr;
+        thread_local int current_worker = -1;
+    }
+    
+    std::shared_ptr<WorkerPool> WorkerPool::shared() {
+        static std::shared_ptr<WorkerPool> pool =
+        std::make_shared<WorkerPool>(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+        return pool;
+    }
+    
+    WorkerPool::WorkerPool(int thread_num):
+    next_worker_(0),
+    pending_(0),
+    quit_(false)
+    {
+        for (int i = 0; i < thread_num; i++) {
+            workers_.push_back(std::unique_ptr<Worker>(new Worker()));
+        }
+        //  after all the deques exist, as a worker steals from any of them
+        for (int i = 0; i < thread_num; i++) {
+            workers_[i]->thread = std::thread([this, i]{
+                WorkerMain(i);
+            });
+        }
+    }
+    
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lk(idle_mutex_);
+            quit_ = true;
+        }
+        idle_cond_.notify_all();
+        for (auto & worker : workers_) {
+            worker->thread.join();
+        }
+    }
+    
+    void WorkerPool::PostTask(Task && task) {
+        int index;
+        if (current_pool == this) {
+            index = current_worker;
+        } else {
+            index = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        }
+        {
+            Worker & worker = *workers_[index];
+            std::lock_guard<std::mutex> lk(worker.mutex);
+            worker.tasks.push_back(TaskInstrument::shared().Wrap("WorkerPool", std::move(task)));
+        }
+        {
+            std::lock_guard<std::mutex> lk(idle_mutex_);
+            pending_.fetch_add(1, std::memory_order_relaxed);
+        }
+        idle_cond_.notify_one();
+    }
+    
+    void WorkerPool::WorkerMain(int index) {
+        current_pool = this;
+        current_worker = index;
+        
+        while (true) {
+            Task task;
+            if (TakeTask(index, task)) {
+                task();
+                continue;
+            }
+            
+            std::unique_lock<std::mutex> lk(idle_mutex_);
+            idle_cond_.wait(lk, [this]{
+                return quit_ || pending_.load(std::memory_order_relaxed) > 0;
+            });
+            //  the tasks left are run before quitting
+            if (quit_ && pending_.load(std::memory_order_relaxed) == 0) {
+                break;
+            }
+        }
+        
+        current_pool = nullptr;
+        current_worker = -1;
+    }
+    
+    bool WorkerPool::TakeTask(int index, Task & task) {
+        const int num = static_cast<int>(workers_.size());
+        for (int i = 0; i < num; i++) {
+            Worker & worker = *workers_[(index + i) % num];
+            std::lock_guard<std::mutex> lk(worker.mutex);
+            if (worker.tasks.size() == 0) {
+                continue;
+            }
+            //  the own newest is warm in the cache; the others' oldest waited longest
+            if (i == 0) {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            } else {
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            }
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,162 @@
+//
+//  worker_pool.h
+//  Ikadenwa
+//
+//  Created by agent on 2026/10/16.
+//  Copyright © 2026年 agent. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "task_queue.h"
+
+namespace nwr {
+    //  a TaskQueue over a few threads, for CPU bound work off the owner queues.
+    //  every worker has its own deque. it runs the newest of its own first,
+    //  and steals the oldest of the others when it runs out.
+    //  tasks run in no particular order; use WorkerStage for ordered results.
+    class WorkerPool: public TaskQueue {
+    public:
+        //  the process wide pool, one thread less than the cores
+        static std::shared_ptr<WorkerPool> shared();
+        
+        explicit WorkerPool(int thread_num);
+        //  runs the tasks left, then joins the threads
+        virtual ~WorkerPool();
+        
+        //  from a worker, to its own deque; from outside, to the workers in turn
+        void PostTask(Task && task) override;
+        
+        int thread_num() const { return static_cast<int>(workers_.size()); }
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+        
+        void WorkerMain(int index);
+        bool TakeTask(int index, Task & task);
+        
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<unsigned> next_worker_;
+        
+        //  pending_ is raised under idle_mutex_, so a sleeping worker never misses it
+        std::mutex idle_mutex_;
+        std::condition_variable idle_cond_;
+        std::atomic<int> pending_;
+        bool quit_;
+    };
+    
+    //  runs each work on a WorkerPool and calls the sink with its result
+    //  on the owner queue, in the order of Run.
+    //  a decoder moves its parsing here without reordering its output.
+    //  the work must not touch the state of the owner.
+    template <typename T>
+    class WorkerStage: public std::enable_shared_from_this<WorkerStage<T>> {
+    public:
+        using Sink = std::function<void(const T &)>;
+        
+        //  on the shared pool, delivering to the current queue
+        static std::shared_ptr<WorkerStage<T>> Create(const Sink & sink) {
+            return std::make_shared<WorkerStage<T>>(WorkerPool::shared(), TaskQueue::current_queue(), sink);
+        }
+        
+        WorkerStage(const std::shared_ptr<WorkerPool> & pool,
+                    const std::shared_ptr<TaskQueue> & queue,
+                    const Sink & sink):
+        pool_(pool),
+        queue_(queue),
+        sink_(sink),
+        next_run_(0),
+        next_delivery_(0),
+        delivery_posted_(false),
+        closed_(false)
+        {}
+        
+        //  on the owner queue. work is a callable returning T
+        template <typename F>
+        void Run(F && work) {
+            auto thiz = this->shared_from_this();
+            const uint64_t sequence = next_run_;
+            next_run_ += 1;
+            pool_->PostTask(Task(NWR_HERE, [thiz, sequence, work = std::forward<F>(work)]() mutable {
+                thiz->Complete(sequence, work());
+            }));
+        }
+        
+        //  on the owner queue. the results not delivered yet are dropped
+        void Close() {
+            //  released out of the lock, as a result may own the owner of this
+            std::map<uint64_t, T> dropped;
+            std::lock_guard<std::mutex> lk(mutex_);
+            closed_ = true;
+            dropped.swap(results_);
+        }
+    private:
+        void Complete(uint64_t sequence, T && result) {
+            bool post;
+            {
+                std::lock_guard<std::mutex> lk(mutex_);
+                if (closed_) { return; }
+                results_.emplace(sequence, std::move(result));
+                post = sequence == next_delivery_ && !delivery_posted_;
+                if (post) {
+                    delivery_posted_ = true;
+                }
+            }
+            if (post) {
+                auto thiz = this->shared_from_this();
+                queue_->PostTask(Task(NWR_HERE, [thiz]{
+                    thiz->Deliver();
+                }));
+            }
+        }
+        
+        void Deliver() {
+            std::vector<T> results;
+            {
+                std::lock_guard<std::mutex> lk(mutex_);
+                delivery_posted_ = false;
+                //  only the results in order; a gap waits for its Complete to post again
+                auto iter = results_.begin();
+                while (iter != results_.end() && iter->first == next_delivery_) {
+                    results.push_back(std::move(iter->second));
+                    next_delivery_ += 1;
+                    iter = results_.erase(iter);
+                }
+            }
+            for (const auto & result : results) {
+                //  the sink may Close this
+                {
+                    std::lock_guard<std::mutex> lk(mutex_);
+                    if (closed_) { return; }
+                }
+                sink_(result);
+            }
+        }
+        
+        std::shared_ptr<WorkerPool> pool_;
+        std::shared_ptr<TaskQueue> queue_;
+        Sink sink_;
+        
+        //  owner queue only
+        uint64_t next_run_;
+        
+        std::mutex mutex_;
+        std::map<uint64_t, T> results_;
+        uint64_t next_delivery_;
+        bool delivery_posted_;
+        bool closed_;
+    };
+}
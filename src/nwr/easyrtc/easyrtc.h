@@ -22,9 +22,11 @@
 #include <nwr/base/map.h>
 #include <nwr/base/optional.h>
 #include <nwr/base/timer.h>
+#include <nwr/base/promise.h>
 #include <nwr/base/json.h>
 #include <nwr/base/func.h>
 #include <nwr/base/any.h>
+#include <nwr/base/any_arena.h>
 #include <nwr/base/any_func.h>
 #include <nwr/base/any_emitter.h>
 #include <nwr/base/objc_pointer.h>
@@ -134,7 +136,7 @@ namespace ert {
         Optional<std::string> username_;
         bool logging_out_;
         bool disconnecting_;
-        std::map<std::string, Any> session_fields_;
+        Any::ObjectType session_fields_;
         std::shared_ptr<MediaTrackConstraints> received_media_constraints_;
     public:
         void EnableAudioReceive(bool value);
@@ -147,10 +149,10 @@ namespace ert {
         std::function<void (const std::string &)> debug_printer_;
         Optional<std::string> my_easyrtcid_;
         Any old_config_;
-        std::map<std::string, Any> offers_pending_;
+        Any::ObjectType offers_pending_;
         int native_video_height_;
         int native_video_width_;
-        std::map<std::string, Any> room_join_;
+        Any::ObjectType room_join_;
         bool IsNameValid(const std::string & name);
         void set_cookie_id(const std::string & cookie_id);
     public:
@@ -188,12 +190,12 @@ namespace ert {
                                 const std::shared_ptr<MediaTrackConstraints> & constraints);
         webrtc::DataChannelInit GetDataChannelConstraints();
         std::string server_path_;
-        std::map<std::string, Any> last_logged_in_list_;
+        Any::ObjectType last_logged_in_list_;
         ReceivePeer receive_peer_;
         std::map<std::string, std::shared_ptr<PeerConn>> peer_conns_;
         std::map<std::string, bool> acceptance_pending_;
         //  GetPeerStatistics
-        std::map<std::string, std::map<std::string, Any>> room_api_fields_;
+        std::map<std::string, Any::ObjectType> room_api_fields_;
         bool websocket_connected_;
         void SetRoomApiField(const std::string & room_name);
         void SetRoomApiField(const std::string & room_name,
@@ -204,7 +206,7 @@ namespace ert {
         TimerPtr room_api_field_timer_;
         void EnqueueSendRoomApi(const std::string & room_name);
         void SendRoomApiFields(const std::string & roomName,
-                               const std::map<std::string, Any> & fields);
+                               const Any::ObjectType & fields);
     public:
         void ShowError(const std::string & message_code, const std::string & message);
     private:
@@ -213,11 +215,11 @@ namespace ert {
         std::function<void(bool, const std::string &)> room_entry_listener_;
         void set_room_entry_listener(const std::function<void(bool, const std::string &)> & handler);
         std::function<void(const Optional<std::string> &,
-                           const std::map<std::string, Any> &,
+                           const Any::ObjectType &,
                            const Any &)> room_occupant_listener_;
     public:
         void set_room_occupant_listener(const std::function<void(const Optional<std::string> &,
-                                                                 const std::map<std::string, Any> &,
+                                                                 const Any::ObjectType &,
                                                                  const Any &)> & listener);
     private:
         std::function<void(const std::string &, bool)> on_data_channel_open_;
@@ -248,8 +250,8 @@ namespace ert {
         std::map<std::string, std::shared_ptr<MediaStream>> named_local_media_streams_;
         std::shared_ptr<MediaStream> GetLocalMediaStreamByName(const Optional<std::string> & stream_name);
         std::vector<std::string> GetLocalMediaIds();
-        std::map<std::string, Any> BuildMediaIds();
-        std::map<std::string, Any> room_data_;
+        Any::ObjectType BuildMediaIds();
+        Any::ObjectType room_data_;
         void RegisterLocalMediaStreamByName(const std::shared_ptr<MediaStream> & stream,
                                             const Optional<std::string> & stream_name);
         void Register3rdPartyLocalMediaStream(const std::shared_ptr<MediaStream> & stream,
@@ -466,16 +468,16 @@ namespace ert {
         void EmitOnStreamClosed(const std::string & easyrtcid,
                                 const std::shared_ptr<MediaStream> &stream);
         void OnRemoteHangup(const std::string & caller);
-        std::map<std::string, Any> queued_messages_;
+        Any::ObjectType queued_messages_;
         void ClearQueuedMessages(const std::string & caller);
         bool IsPeerInAnyRoom(const std::string & id);
-        void ProcessLostPeers(const std::map<std::string, Any> & peers_in_room);
+        void ProcessLostPeers(const Any::ObjectType & peers_in_room);
         std::map<std::string, AggregatingTimer> aggregating_timers_;
         void AddAggregatingTimer(const std::string & key,
                                  const std::function<void()> & callback,
                                  const Optional<TimeDuration> & arg_period);
         void ProcessOccupantList(const std::string & room_name,
-                                 std::map<std::string, Any> & occupant_list);
+                                 const Any::ObjectType & occupant_list);
         void SendQueuedCandidates(const std::string & peer,
                                   const std::function<void (const std::string &,
                                                             const Any &)> & on_signal_success,
@@ -496,24 +498,24 @@ namespace ert {
         void UpdateConfigurationInfo();
         std::function<void()> update_configuration_info_;
         void UpdatePresence(const std::string & state, const std::string & status_text);
-        std::map<std::string, Any> GetSessionFields();
+        Any::ObjectType GetSessionFields();
         Any GetSessionField(const std::string & name);
         Optional<std::string> easyrtcsid_;
         void ProcessSessionData(const Any & session_data);
-        void ProcessRoomData(const Any & room_data);
+        void ProcessRoomData(const Any & arg_room_data);
         std::vector<std::string> GetRoomOccupantsAsArray(const std::string & room_name);
-        std::map<std::string, Any> GetRoomOccupantsAsMap(const std::string & room_name);
+        Any::ObjectType GetRoomOccupantsAsMap(const std::string & room_name);
         bool IsTurnServer(const std::string & ip_address);
         void ProcessIceConfig(const Any & arg_ice_config);
-        void GetFreshIceConfig(const std::function<void(bool)> & callback);
+        //  rejected when the server answers with an error
+        PromisePtr<None> GetFreshIceConfig();
         void ProcessToken(const Any & msg);
-        void SendAuthenticate(const std::function<void (const std::string &)> & success_callback,
-                              const std::function<void (const std::string &,
-                                                        const std::string &)> & error_callback);
+        //  settled by the answer of the server, an error message included
+        PromisePtr<Any> SendAuthenticate();
         std::map<std::string, bool> GetRoomsJoined();
-        std::map<std::string, Any> GetRoomFields(const std::string & room_name);
-        std::map<std::string, Any> GetApplicationFields();
-        std::map<std::string, Any> GetConnectionFields();
+        Any::ObjectType GetRoomFields(const std::string & room_name);
+        Any::ObjectType GetApplicationFields();
+        Any::ObjectType GetConnectionFields();
         std::shared_ptr<sio0::Socket> preallocated_socket_io_;
         void UseThisSocketConnection(const std::shared_ptr<sio0::Socket> & already_allocated_socket_io);
     public:
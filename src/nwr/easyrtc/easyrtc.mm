@@ -42,6 +42,8 @@ namespace ert {
         
         connection_options_.connect_timeout = Some(TimeDuration(10.0));
         connection_options_.force_new_connection = Some(true);
+        //  large occupant lists parse off the main queue
+        connection_options_.decode_on_worker = Some(true);
         
         have_audio_ = false;
         have_video_ = false;
@@ -53,7 +55,7 @@ namespace ert {
         
         api_version_ = "1.0.15";
         Any ack_message_ = Any(Any::ObjectType {
-            { "msgType", Any("ack") }
+            { atoms::kMsgType, Any("ack") }
         });
         username_regexp_ = std::regex("^(.){1,64}$");
         cookie_id_ = "easyrtcsid";
@@ -78,7 +80,7 @@ namespace ert {
         data_enabled_ = false;
         on_error_ = [this](const Any & error) {
             FuncCall(debug_printer_,
-                     "saw error" + (error.GetAt("errorText").AsString() || std::string("")));
+                     "saw error" + (error.GetAt(atoms::kErrorText).AsString() || std::string("")));
             printf("[Easyrtc::on_error_] %s\n", error.ToJsonString().c_str());
         };
         pc_config_ = std::make_shared<webrtc::PeerConnectionInterface::RTCConfiguration>();
@@ -170,9 +172,9 @@ namespace ert {
     
     Any Easyrtc::CreateIceServer(const std::string & url, const std::string & username, const std::string & credential) {
         return Any(Any::ObjectType{
-            { "url", Any(url) },
-            { "username", Any(username) },
-            { "credential", Any(credential) }
+            { Atom("url"), Any(url) },
+            { Atom("username"), Any(username) },
+            { Atom("credential"), Any(credential) }
         });
     }
     
@@ -311,13 +313,13 @@ namespace ert {
     {
         auto thiz = shared_from_this();
         
-        if (HasKey(room_join_, room_name)) {
+        if (HasKey(room_join_, Atom(room_name))) {
             printf("Developer error: attempt to join room %s which you are already in.\n", room_name.c_str());
             return;
         }
         
         Any new_room_data(Any::ObjectType {
-            { "roomName", Any(room_name) }
+            { atoms::kRoomName, Any(room_name) }
         });
         if (room_parameters.type() == Any::Type::Object) {
             Any parameters(Any::ObjectType(room_parameters.AsObject().value()));
@@ -325,7 +327,7 @@ namespace ert {
         }
         
         Any msg_data(Any::ObjectType {
-            { "roomJoin", Any(Any::ObjectType()) }
+            { Atom("roomJoin"), Any(Any::ObjectType()) }
         });
         
         if (websocket_) {
@@ -336,9 +338,9 @@ namespace ert {
             [thiz, room_name, new_room_data, success_cb]
             (const std::string & msg_type, const Any & msg_data) {
                 
-                Any room_data = msg_data.GetAt("roomData");
+                Any room_data = msg_data.GetAt(atoms::kRoomData);
     
-                thiz->room_join_[room_name] = new_room_data;
+                thiz->room_join_[Atom(room_name)] = new_room_data;
                 
                 if (success_cb) {
                     success_cb(room_name);
@@ -363,7 +365,7 @@ namespace ert {
             SendSignaling(None(), "roomJoin", msg_data, signaling_success, signaling_failure);
         }
         else {
-            room_join_[room_name] = new_room_data;
+            room_join_[Atom(room_name)] = new_room_data;
         }
     }
     
@@ -375,21 +377,21 @@ namespace ert {
     {
         auto thiz = shared_from_this();
         
-        if (HasKey(room_join_, room_name)) {
+        if (HasKey(room_join_, Atom(room_name))) {
             if (!websocket_) {
-                room_join_.erase(room_name);
+                room_join_.erase(Atom(room_name));
             }
             else {
                 Any room_item(Any::ObjectType{});
                 
                 room_item.SetAt(room_name, Any(Any::ObjectType {
-                    { "roomName", Any(room_name) }
+                    { atoms::kRoomName, Any(room_name) }
                 }));
                 
                 SendSignaling(None(), "roomLeave",
-                              Any(Any::ObjectType { { "roomLeave", room_item } }),
+                              Any(Any::ObjectType { { Atom("roomLeave"), room_item } }),
                               [thiz, room_name, success_callback](const std::string & msg_type, const Any & msg_data) {
-                                  Any room_data = msg_data.GetAt("roomData");
+                                  Any room_data = msg_data.GetAt(atoms::kRoomData);
                                   thiz->ProcessRoomData(room_data);
                                   if (success_callback) {
                                       success_callback(room_name);
@@ -509,16 +511,16 @@ namespace ert {
     void Easyrtc::SetRoomApiField(const std::string & room_name,
                                   const std::string & field_name)
     {
-        room_api_fields_[room_name].erase(field_name);
+        room_api_fields_[room_name].erase(Atom(field_name));
     }
     
     void Easyrtc::SetRoomApiField(const std::string & room_name,
                                   const std::string & field_name,
                                   const Any & field_value)
     {
-        room_api_fields_[room_name][field_name] = Any(Any::ObjectType {
-            { "fieldName", Any(field_name) },
-            { "fieldValue", field_value }
+        room_api_fields_[room_name][Atom(field_name)] = Any(Any::ObjectType {
+            { Atom("fieldName"), Any(field_name) },
+            { Atom("fieldValue"), field_value }
         });
         
         if (websocket_connected_) {
@@ -541,16 +543,16 @@ namespace ert {
     }
     
     void Easyrtc::SendRoomApiFields(const std::string & roomName,
-                                    const std::map<std::string, Any> & fields)
+                                    const Any::ObjectType & fields)
     {
         auto thiz = shared_from_this();
         
         Any data_to_ship(Any::ObjectType {
-            { "msgType", Any("setRoomApiField") },
-            { "msgData", Any(Any::ObjectType {
-                { "setRoomApiField", Any(Any::ObjectType {
-                    { "roomName", Any(roomName) },
-                    { "field", Any(fields) }
+            { atoms::kMsgType, Any("setRoomApiField") },
+            { atoms::kMsgData, Any(Any::ObjectType {
+                { Atom("setRoomApiField"), Any(Any::ObjectType {
+                    { atoms::kRoomName, Any(roomName) },
+                    { atoms::kField, Any(fields) }
                 }) }
             }) }
         });
@@ -558,9 +560,9 @@ namespace ert {
         websocket_->JsonEmit("easyrtcCmd", {
             data_to_ship,
             AnyFuncMake([thiz](const Any & ack_msg) {
-                if (ack_msg.GetAt("msgType").AsString() == Some(std::string("error"))) {
-                    thiz->ShowError(ack_msg.GetAt("msgData").GetAt("errorCode").AsString() || std::string(),
-                                    ack_msg.GetAt("msgData").GetAt("errorText").AsString() || std::string());
+                if (ack_msg.GetAt(atoms::kMsgType).AsString() == Some(std::string("error"))) {
+                    thiz->ShowError(ack_msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorCode).AsString() || std::string(),
+                                    ack_msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorText).AsString() || std::string());
                 }
             })
         });
@@ -568,8 +570,8 @@ namespace ert {
     
     void Easyrtc::ShowError(const std::string & message_code, const std::string & message) {
         FuncCall(on_error_, Any(Any::ObjectType {
-            { "errorCode", Any(message_code) },
-            { "errorText", Any(message) }
+            { atoms::kErrorCode, Any(message_code) },
+            { atoms::kErrorText, Any(message) }
         }) );
     }
     
@@ -589,7 +591,7 @@ namespace ert {
     }
     
     void Easyrtc::set_room_occupant_listener(const std::function<void(const Optional<std::string> &,
-                                                                      const std::map<std::string, Any> &,
+                                                                      const Any::ObjectType &,
                                                                       const Any &)> & listener) {
         room_occupant_listener_ = listener;
     }
@@ -651,11 +653,11 @@ namespace ert {
         return Keys(named_local_media_streams_);
     }
     
-    std::map<std::string, Any> Easyrtc::BuildMediaIds() {
-        std::map<std::string, Any> media_map;
+    Any::ObjectType Easyrtc::BuildMediaIds() {
+        Any::ObjectType media_map;
         for (auto iter : named_local_media_streams_) {
             auto id = iter.second->id();
-            media_map[iter.first] = Any(std::string(id != "" ? id : "default"));
+            media_map[Atom(iter.first)] = Any(std::string(id != "" ? id : "default"));
         }
         return media_map;
     }
@@ -670,7 +672,7 @@ namespace ert {
         if (stream_name != "default") {
             auto media_ids = BuildMediaIds();
             for (const auto & i : room_data_) {
-                SetRoomApiField(i.first, "mediaIds", Any(media_ids));
+                SetRoomApiField(i.first.str(), "mediaIds", Any(media_ids));
             }
         }
     }
@@ -691,16 +693,17 @@ namespace ert {
         }
         
         for (const auto & i : room_data_) {
-            const std::string & room_name = i.first;
+            const std::string & room_name = i.first.str();
             
             Any media_ids = GetRoomApiField(room_name, easyrtcid, "mediaIds");
-            if (!media_ids) {
+            auto media_ids_object = media_ids.AsObjectPointer();
+            if (!media_ids_object) {
                 continue;
             }
 
-            for (const auto & stream_name : media_ids.keys()) {
-                if (media_ids.GetAt(stream_name).AsString() == Some(webrtc_stream_id)) {
-                    return Some(stream_name);
+            for (const auto & entry : *media_ids_object) {
+                if (entry.second.AsString() == Some(webrtc_stream_id)) {
+                    return Some(entry.first.str());
                 }
             }
 
@@ -722,8 +725,8 @@ namespace ert {
             for (const auto & id : Keys(peer_conns_)) {
                 peer_conns_[id]->pc()->RemoveStream(stream);
                 SendPeerMessage(Any(id), "__closingMediaStream", Any(Any::ObjectType {
-                    { "streamId", Any(stream_id) },
-                    { "streamName", Any(stream_name) }
+                    { Atom("streamId"), Any(stream_id) },
+                    { Atom("streamName"), Any(stream_name) }
                 }), nullptr, nullptr);
             }
             
@@ -733,7 +736,7 @@ namespace ert {
             if (stream_name != "default") {
                 auto media_ids = BuildMediaIds();
                 for (const auto & i : room_data_) {
-                    SetRoomApiField(i.first, "mediaIds", Any(media_ids));
+                    SetRoomApiField(i.first.str(), "mediaIds", Any(media_ids));
                 }
             }
         }
@@ -998,8 +1001,8 @@ namespace ert {
                                         const Any & msg,
                                         const Any & targeting)
     {
-        Optional<std::string> msg_type_opt = msg.GetAt("msgType").AsString();
-        Any msg_data = msg.GetAt("msgData");
+        Optional<std::string> msg_type_opt = msg.GetAt(atoms::kMsgType).AsString();
+        Any msg_data = msg.GetAt(atoms::kMsgData);
         if (!msg_type_opt) {
             printf("received peer message without msgType; %s\n", msg.ToJsonString().c_str());
             return;
@@ -1069,12 +1072,11 @@ namespace ert {
                 continue;
             }
             
-            for (const std::string & id : last_logged_in_list_[room_name].keys()) {
-                auto entry = last_logged_in_list_[room_name].GetAt(id);
+            last_logged_in_list_[Atom(room_name)].ForEach([&](const std::string & id, const Any & entry) {
                 if (entry.GetAt("username").AsString() == Some(username)) {
                     results.push_back(std::tuple<std::string, std::string>(id, room_name));
                 }
-            }
+            });
         }
         return results;
     }
@@ -1084,10 +1086,10 @@ namespace ert {
                                  const std::string & field_name)
     {
 
-        if (HasKey(last_logged_in_list_, room_name) &&
-            last_logged_in_list_[room_name].HasKey(easyrtcid))
+        if (HasKey(last_logged_in_list_, Atom(room_name)) &&
+            last_logged_in_list_[Atom(room_name)].HasKey(easyrtcid))
         {
-            auto info = last_logged_in_list_[room_name].GetAt(easyrtcid);
+            auto info = last_logged_in_list_[Atom(room_name)].GetAt(easyrtcid);
             if (info.GetAt("apiField").HasKey(field_name)) {
                 return info.GetAt("apiField").GetAt(field_name).GetAt("fieldValue");
             }
@@ -1105,8 +1107,8 @@ namespace ert {
     
     std::string Easyrtc::IdToName(const std::string & easyrtcid) {
         for (const std::string & room_name : Keys(last_logged_in_list_)) {
-            if (last_logged_in_list_[room_name].HasKey(easyrtcid)) {
-                auto entry = last_logged_in_list_[room_name].GetAt(easyrtcid);
+            if (last_logged_in_list_[Atom(room_name)].HasKey(easyrtcid)) {
+                auto entry = last_logged_in_list_[Atom(room_name)].GetAt(easyrtcid);
                 if (entry.GetAt("username")) {
                     return entry.GetAt("username").AsString().value();
                 }
@@ -1166,7 +1168,7 @@ namespace ert {
     
     Any Easyrtc::GetRoomField(const std::string & room_name, const std::string & field_name) {
         auto fields = GetRoomFields(room_name);
-        return fields[field_name].GetAt("fieldValue");
+        return fields[Atom(field_name)].GetAt("fieldValue");
     }
     
     bool Easyrtc::SupportsStatistics() {
@@ -1194,7 +1196,7 @@ namespace ert {
         HangupAll();
         if (room_occupant_listener_) {
             for (const auto & key : Keys(last_logged_in_list_)) {
-                (room_occupant_listener_)(Some(key), std::map<std::string, Any>{}, Any());
+                (room_occupant_listener_)(Some(key), Any::ObjectType{}, Any());
             }
         }
         last_logged_in_list_.clear();
@@ -1234,7 +1236,7 @@ namespace ert {
             thiz->logging_out_ = false;
             thiz->disconnecting_ = false;
             
-            FuncCall(thiz->room_occupant_listener_, None(), std::map<std::string, Any>{}, Any());
+            FuncCall(thiz->room_occupant_listener_, None(), Any::ObjectType{}, Any());
             
             thiz->EmitEvent("roomOccupant", Any(Any::ObjectType{}));
             thiz->old_config_ = Any(Any::ObjectType{});
@@ -1256,14 +1258,14 @@ namespace ert {
         }
         else {
             Any data_to_ship(Any::ObjectType {
-                { "msgType", Any(msg_type) }
+                { atoms::kMsgType, Any(msg_type) }
             });
             
             if (dest_user) {
-                data_to_ship.SetAt("targetEasyrtcid", Any(dest_user.value()));
+                data_to_ship.SetAt(atoms::kTargetEasyrtcid, Any(dest_user.value()));
             }
             if (msg_data) {
-                data_to_ship.SetAt("msgData", msg_data);
+                data_to_ship.SetAt(atoms::kMsgData, msg_data);
             }
 
             FuncCall(debug_printer_,
@@ -1275,18 +1277,18 @@ namespace ert {
                             (const Any & arg_ack_msg) {
                                 Any ack_msg = arg_ack_msg;
                                 
-                                if (ack_msg.GetAt("msgType").AsString() != Some(std::string("error")) ) {
-                                    if (!ack_msg.HasKey("msgData")) {
-                                        ack_msg.SetAt("msgData", nullptr);
+                                if (ack_msg.GetAt(atoms::kMsgType).AsString() != Some(std::string("error")) ) {
+                                    if (!ack_msg.HasKey(atoms::kMsgData)) {
+                                        ack_msg.SetAt(atoms::kMsgData, nullptr);
                                     }
                                     FuncCall(success_callback,
-                                             ack_msg.GetAt("msgType").AsString() || std::string(),
-                                             ack_msg.GetAt("msgData"));
+                                             ack_msg.GetAt(atoms::kMsgType).AsString() || std::string(),
+                                             ack_msg.GetAt(atoms::kMsgData));
                                 }
                                 else {
-                                    auto msg_data = ack_msg.GetAt("msgData");
-                                    auto error_code = msg_data.GetAt("errorCode").AsString() || std::string();
-                                    auto error_text = msg_data.GetAt("errorText").AsString() || std::string();
+                                    auto msg_data = ack_msg.GetAt(atoms::kMsgData);
+                                    auto error_code = msg_data.GetAt(atoms::kErrorCode).AsString() || std::string();
+                                    auto error_text = msg_data.GetAt(atoms::kErrorText).AsString() || std::string();
                                     
                                     if (error_callback) {
                                         error_callback(error_code, error_text);
@@ -1305,14 +1307,14 @@ namespace ert {
         int number_of_chunks = static_cast<int>(ceil(static_cast<double>(msg_data.length()) / max_p2p_message_length_));
 
         Any start_message(Any::ObjectType {
-            { "transfer", Any("start") },
-            { "transferId", Any(transfer_id) },
-            { "parts", Any(number_of_chunks) }
+            { Atom("transfer"), Any("start") },
+            { Atom("transferId"), Any(transfer_id) },
+            { Atom("parts"), Any(number_of_chunks) }
         });
         
         Any end_message(Any::ObjectType {
-            { "transfer", Any("end") },
-            { "transfer_id", Any(transfer_id) }
+            { Atom("transfer"), Any("end") },
+            { Atom("transfer_id"), Any(transfer_id) }
         });
         
         peer_conns_[dest_user]->data_channel_s()->Send(eio::PacketData(start_message.ToJsonString()));
@@ -1321,9 +1323,9 @@ namespace ert {
         int len = static_cast<int>(msg_data.length());
         for (; pos < len; pos += max_p2p_message_length_) {
             Any message(Any::ObjectType {
-                { "transfer_id", Any(transfer_id) },
-                { "data", Any(msg_data.substr(pos, max_p2p_message_length_)) },
-                { "transfer", Any("chunk") }
+                { Atom("transfer_id"), Any(transfer_id) },
+                { Atom("data"), Any(msg_data.substr(pos, max_p2p_message_length_)) },
+                { Atom("transfer"), Any("chunk") }
             });
 
             peer_conns_[dest_user]->data_channel_s()->Send(eio::PacketData(message.ToJsonString()));
@@ -1337,7 +1339,7 @@ namespace ert {
                               const Any & msg_data)
     {
         std::string flattened_data = Any(Any::ObjectType {
-            { "msgType", Any(msg_type) }, { "msgData", msg_data }
+            { atoms::kMsgType, Any(msg_type) }, { atoms::kMsgData, msg_data }
         }).ToJsonString();
         
         FuncCall(debug_printer_,
@@ -1384,31 +1386,31 @@ namespace ert {
         
         if (!ack_handler) {
             ack_handler = [thiz](const Any & msg) {
-                if (msg.GetAt("msgType").AsString() == Some(std::string("error"))) {
-                    thiz->ShowError(msg.GetAt("msgData").GetAt("errorCode").AsString() || std::string(),
-                                    msg.GetAt("msgData").GetAt("errorText").AsString() || std::string());
+                if (msg.GetAt(atoms::kMsgType).AsString() == Some(std::string("error"))) {
+                    thiz->ShowError(msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorCode).AsString() || std::string(),
+                                    msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorText).AsString() || std::string());
                 }
             };
         }
         
         Any outgoing_message(Any::ObjectType {
-            { "msgType", Any(msg_type) },
-            { "msgData", msg_data }
+            { atoms::kMsgType, Any(msg_type) },
+            { atoms::kMsgData, msg_data }
         });
         
         if (destination) {
             if (destination.type() == Any::Type::String) {
-                outgoing_message.SetAt("targetEasyrtcid", destination);
+                outgoing_message.SetAt(atoms::kTargetEasyrtcid, destination);
             }
             else if (destination.type() == Any::Type::Object) {
-                if (destination.GetAt("targetEasyrtcid")) {
-                    outgoing_message.SetAt("targetEasyrtcid", destination.GetAt("targetEasyrtcid"));
+                if (destination.GetAt(atoms::kTargetEasyrtcid)) {
+                    outgoing_message.SetAt(atoms::kTargetEasyrtcid, destination.GetAt(atoms::kTargetEasyrtcid));
                 }
-                if (destination.GetAt("targetRoom")) {
-                    outgoing_message.SetAt("targetRoom", destination.GetAt("targetRoom"));
+                if (destination.GetAt(atoms::kTargetRoom)) {
+                    outgoing_message.SetAt(atoms::kTargetRoom, destination.GetAt(atoms::kTargetRoom));
                 }
-                if (destination.GetAt("targetGroup")) {
-                    outgoing_message.SetAt("targetGroup", destination.GetAt("targetGroup"));
+                if (destination.GetAt(atoms::kTargetGroup)) {
+                    outgoing_message.SetAt(atoms::kTargetGroup, destination.GetAt(atoms::kTargetGroup));
                 }
             }
         }
@@ -1451,15 +1453,15 @@ namespace ert {
         FuncCall(debug_printer_, std::string("sending peer message ") + msg_data.ToJsonString());
 
         auto ack_handler = [success_cb, failure_cb](const Any & response) {
-            if (response.GetAt("msgType").AsString() == Some(std::string("error"))) {
+            if (response.GetAt(atoms::kMsgType).AsString() == Some(std::string("error"))) {
                 FuncCall(failure_cb,
-                         response.GetAt("msgData").GetAt("errorCode").AsString() || std::string(),
-                         response.GetAt("msgData").GetAt("errorText").AsString() || std::string());
+                         response.GetAt(atoms::kMsgData).GetAt(atoms::kErrorCode).AsString() || std::string(),
+                         response.GetAt(atoms::kMsgData).GetAt(atoms::kErrorText).AsString() || std::string());
             }
             else {
                 FuncCall(success_cb,
-                         response.GetAt("msgType").AsString() || std::string(),
-                         response.GetAt("msgData"));
+                         response.GetAt(atoms::kMsgType).AsString() || std::string(),
+                         response.GetAt(atoms::kMsgData));
             }
         };
         
@@ -1475,22 +1477,22 @@ namespace ert {
     {
         if (debug_printer_) {
             Any data_to_ship(Any::ObjectType {
-                { "msgType", Any(msg_type) },
-                { "msgData", msg_data }
+                { atoms::kMsgType, Any(msg_type) },
+                { atoms::kMsgData, msg_data }
             });
             FuncCall(debug_printer_, std::string("sending server message ") + data_to_ship.ToJsonString());
         }
         
         auto ack_handler = [success_cb, failure_cb](const Any & response){
-            if (response.GetAt("msgType").AsString() == Some(std::string("error"))) {
+            if (response.GetAt(atoms::kMsgType).AsString() == Some(std::string("error"))) {
                 FuncCall(failure_cb,
-                         response.GetAt("msgData").GetAt("errorCode").AsString() || std::string(),
-                         response.GetAt("msgData").GetAt("errorText").AsString() || std::string());
+                         response.GetAt(atoms::kMsgData).GetAt(atoms::kErrorCode).AsString() || std::string(),
+                         response.GetAt(atoms::kMsgData).GetAt(atoms::kErrorText).AsString() || std::string());
             }
             else {
                 FuncCall(success_cb,
-                         response.GetAt("msgType").AsString() || std::string(),
-                         response.GetAt("msgData"));
+                         response.GetAt(atoms::kMsgType).AsString() || std::string(),
+                         response.GetAt(atoms::kMsgData));
             }
         };
         
@@ -1597,10 +1599,10 @@ namespace ert {
         // If B calls A, and then A calls B before accepting, then A should treat the attempt to
         // call B as a positive offer to B's offer.
         //
-        if (HasKey(offers_pending_, other_user)) {
+        if (HasKey(offers_pending_, Atom(other_user))) {
             FuncCall(was_accepted_cb, true, other_user);
-            DoAnswer(other_user, offers_pending_[other_user], stream_names);
-            offers_pending_.erase(other_user);
+            DoAnswer(other_user, offers_pending_[Atom(other_user)], stream_names);
+            offers_pending_.erase(Atom(other_user));
             FuncCall(call_canceled_, other_user, false);
             return;
         }
@@ -1614,19 +1616,17 @@ namespace ert {
         }
         
         if (use_fresh_ice_each_peer_) {
-            GetFreshIceConfig([thiz, other_user,
+            GetFreshIceConfig()
+            ->Then([thiz, other_user,
                                call_success_cb, call_failure_cb,
                                was_accepted_cb,
-                               stream_names]
-                              (bool succeeded) {
-                                  if (succeeded) {
+                    stream_names](None) {
                                       thiz->CallBody(other_user, call_success_cb, call_failure_cb, was_accepted_cb, stream_names);
-                                  }
-                                  else {
+            })
+            ->Catch([thiz, call_failure_cb](const std::string & error) {
                                       FuncCall(call_failure_cb,
                                                thiz->err_codes_CALL_ERR_,
                                                "Attempt to get fresh ice configuration failed");
-                                  }
                               });
         }
         else {
@@ -1660,48 +1660,39 @@ namespace ert {
         
         auto peer_conn_obj = peer_conns_[other_user];
         
-        auto set_local_and_send_message_0 =
-        [thiz, pc, peer_conn_obj, other_user, call_failure_cb]
-        (const std::shared_ptr<RtcSessionDescription> & session_description) {
-            if (peer_conn_obj->canceled()) {
-                return;
-            }
-            
-            auto send_offer = [thiz, other_user, session_description, call_failure_cb]() {
-                thiz->SendSignaling(Some(other_user),
-                                    "offer",
-                                    session_description->ToAny(),
-                                    nullptr,
-                                    call_failure_cb);
-            };
-            
-            if (thiz->sdp_local_filter_) {
-                session_description->set_sdp(thiz->sdp_local_filter_(session_description->sdp()));
-            }
-            
-            pc->SetLocalDescription(session_description,
-                                    send_offer,
-                                    [thiz, call_failure_cb](const std::string & error_text) {
-                                        call_failure_cb(thiz->err_codes_CALL_ERR_, error_text);
-                                    });
-        };
-        
-        Timer::Create(TimeDuration(0.1),
-                      [thiz, other_user, pc, set_local_and_send_message_0, call_failure_cb]() {
+        Sleep(TimeDuration(0.1))
+        ->Then([thiz, other_user, pc](None) {
                           //
                           // if the call was cancelled, we don't want to continue getting the offer.
                           // we can tell the call was cancelled because there won't be a peerConn object
                           // for it.
                           //
                           if (!thiz->peer_conns_[other_user]) {
-                              return;
+                return PromisePtr<std::shared_ptr<RtcSessionDescription>>();
                           }
                           
-                          pc->CreateOffer(thiz->received_media_constraints_,
-                                          set_local_and_send_message_0,
-                                          [thiz, call_failure_cb](const std::string & error){
-                                              FuncCall(call_failure_cb, thiz->err_codes_CALL_ERR_, error);
-                                          });
+            return pc->CreateOffer(thiz->received_media_constraints_);
+        })
+        ->Then([thiz, pc, peer_conn_obj](const std::shared_ptr<RtcSessionDescription> & session_description) {
+            if (peer_conn_obj->canceled()) {
+                return PromisePtr<std::shared_ptr<const RtcSessionDescription>>();
+            }
+            
+            if (thiz->sdp_local_filter_) {
+                session_description->set_sdp(thiz->sdp_local_filter_(session_description->sdp()));
+            }
+            
+            return pc->SetLocalDescription(session_description);
+        })
+        ->Then([thiz, other_user, call_failure_cb](const std::shared_ptr<const RtcSessionDescription> & session_description) {
+            thiz->SendSignaling(Some(other_user),
+                                "offer",
+                                session_description->ToAny(),
+                                nullptr,
+                                call_failure_cb);
+        })
+        ->Catch([thiz, call_failure_cb](const std::string & error_text) {
+            FuncCall(call_failure_cb, thiz->err_codes_CALL_ERR_, error_text);
                       });
     }
     
@@ -1892,7 +1883,7 @@ namespace ert {
                                           "__gotAddedMediaStream",
                                           Any(Any::ObjectType
                                               {
-                                                  { "sdp", sdp }
+                                                  { Atom("sdp"), sdp }
                                               }),
                                           nullptr, nullptr);
                 };
@@ -2048,7 +2039,7 @@ namespace ert {
                                                                                       "__addedMediaStream",
                                                                                       Any(Any::ObjectType
                                                                                           {
-                                                                                              { "sdp", sdp->ToAny() }
+                                                                                              { Atom("sdp"), sdp->ToAny() }
                                                                                           }),
                                                                                       nullptr,
                                                                                       nullptr);
@@ -2123,10 +2114,10 @@ namespace ert {
             
             if (thiz->peer_conns_[other_user]) {
                 Any candidate_data(Any::ObjectType {
-                    { "type", Any("candidate") },
-                    { "label", Any(candidate->sdp_mline_index()) },
-                    { "id", Any(candidate->sdp_mid()) },
-                    { "candidate", Any(candidate->candidate())  }
+                    { Atom("type"), Any("candidate") },
+                    { Atom("label"), Any(candidate->sdp_mline_index()) },
+                    { Atom("id"), Any(candidate->sdp_mid()) },
+                    { Atom("candidate"), Any(candidate->candidate())  }
                 } );
                                 
                 if (thiz->ice_candidate_filter_) {
@@ -2209,7 +2200,7 @@ namespace ert {
                 thiz->SendDataWS(Any(other_user), "easyrtc_streamReceived",
                                  Any(Any::ObjectType
                                      {
-                                         { "streamName", Any(remote_name) }
+                                         { Atom("streamName"), Any(remote_name) }
                                      }),
                                  nullptr);
             }
@@ -2273,9 +2264,9 @@ namespace ert {
                             int parts = msg.GetAt("parts").AsInt().value();
                             
                             *pending_transfer_ptr = Any(Any::ObjectType {
-                                { "chunks", Any(Any::ArrayType{}) },
-                                { "parts", Any(parts) },
-                                { "transferId", Any(transfer_id) }
+                                { Atom("chunks"), Any(Any::ArrayType{}) },
+                                { Atom("parts"), Any(parts) },
+                                { Atom("transferId"), Any(transfer_id) }
                             });
                         } else if (transfer == "chunk") {
                             FuncCall(thiz->debug_printer_, std::string("got chunk for tranfer #") + transfer_id);
@@ -2295,12 +2286,13 @@ namespace ert {
                                 printf("Developer error, invalid transfer id\n");
                                 
                                 // check that the max length of transfer is not reached
-                            } else if (pending_transfer_ptr->GetAt("chunks").AsArray()->size() + 1 > pending_transfer_ptr->GetAt("parts").AsInt().value()) {
+                            } else if (pending_transfer_ptr->GetAt("chunks").count() + 1 > pending_transfer_ptr->GetAt("parts").AsInt().value()) {
                                 
                                 printf("Developer error, received too many chunks");
                                 
                             } else {
-                                pending_transfer_ptr->GetAt("chunks").AsArray()->push_back(Any(data_opt.value()));
+                                Any chunks = pending_transfer_ptr->GetAt("chunks");
+                                chunks.SetAt(chunks.count(), Any(data_opt.value()));
                             }
                             
                         } else if (transfer == "end") {
@@ -2316,12 +2308,12 @@ namespace ert {
                                 printf("Developer error, invalid transfer id");
                                 
                                 // check that all the chunks were received
-                            } else if (pending_transfer_ptr->GetAt("chunks").AsArray()->size() != pending_transfer_ptr->GetAt("parts").AsInt().value()) {
+                            } else if (pending_transfer_ptr->GetAt("chunks").count() != pending_transfer_ptr->GetAt("parts").AsInt().value()) {
                                 printf("Developer error, received wrong number of chunks");
                                 
                             } else {
                                 
-                                std::vector<std::string> chunks = Map(pending_transfer_ptr->GetAt("chunks").AsArray().value(),
+                                std::vector<std::string> chunks = Map(*pending_transfer_ptr->GetAt("chunks").AsArrayPointer(),
                                                                       [](const Any & value) -> std::string {
                                                                           return value.AsString().value();
                                                                       });
@@ -2497,13 +2489,12 @@ namespace ert {
             }
         }
         if (use_fresh_ice_each_peer_) {
-            GetFreshIceConfig([thiz, caller, msg_data, stream_names](bool succeeded){
-                if (succeeded) {
+            GetFreshIceConfig()
+            ->Then([thiz, caller, msg_data, stream_names](None) {
                     thiz->DoAnswerBody(caller, msg_data, stream_names);
-                }
-                else {
+            })
+            ->Catch([thiz](const std::string & error) {
                     thiz->ShowError(thiz->err_codes_CALL_ERR_, "Failed to get fresh ice config");
-                }
             });
         }
         else {
@@ -2613,7 +2604,7 @@ namespace ert {
     }
     
     void Easyrtc::OnRemoteHangup(const std::string & caller) {
-        offers_pending_.erase(caller);
+        offers_pending_.erase(Atom(caller));
         FuncCall(debug_printer_, "Saw onRemote hangup event");
         
         if (HasKey(peer_conns_, caller)) {
@@ -2642,21 +2633,21 @@ namespace ert {
     }
     
     void Easyrtc::ClearQueuedMessages(const std::string & caller) {
-        queued_messages_[caller] = Any(Any::ObjectType {
-            { "candidates", Any(Any::ArrayType{}) }
+        queued_messages_[Atom(caller)] = Any(Any::ObjectType {
+            { Atom("candidates"), Any(Any::ArrayType{}) }
         });
     }
     
     bool Easyrtc::IsPeerInAnyRoom(const std::string & id) {
         for (const auto & room_name : Keys(last_logged_in_list_)) {
-            if (last_logged_in_list_[room_name].HasKey(id)) {
+            if (last_logged_in_list_[Atom(room_name)].HasKey(id)) {
                 return true;
             }
         }
         return false;
     }
     
-    void Easyrtc::ProcessLostPeers(const std::map<std::string, Any> & peers_in_room) {
+    void Easyrtc::ProcessLostPeers(const Any::ObjectType & peers_in_room) {
         //
         // check to see the person is still in at least one room. If not, we'll hangup
         // on them. This isn't the correct behavior, but it's the best we can do without
@@ -2664,12 +2655,12 @@ namespace ert {
         //
         
         for (const auto & id : Keys(peer_conns_)) {
-            if (!HasKey(peers_in_room, id)) {
+            if (!HasKey(peers_in_room, Atom(id))) {
                 if (!IsPeerInAnyRoom(id)) {
                     if (peer_conns_[id]->pc() || peer_conns_[id]->is_initiator()) {
                         OnRemoteHangup(id);
                     }
-                    offers_pending_.erase(id);
+                    offers_pending_.erase(Atom(id));
                     acceptance_pending_.erase(id);
                     ClearQueuedMessages(id);
                 }
@@ -2680,7 +2671,7 @@ namespace ert {
             if (!IsPeerInAnyRoom(id)) {
                 OnRemoteHangup(id);
                 ClearQueuedMessages(id);
-                offers_pending_.erase(id);
+                offers_pending_.erase(Atom(id));
                 acceptance_pending_.erase(id);
             }
         }
@@ -2725,19 +2716,20 @@ namespace ert {
     }
     
     void Easyrtc::ProcessOccupantList(const std::string & room_name,
-                                      std::map<std::string, Any> & occupant_list)
+                                      const Any::ObjectType & occupant_list)
     {
         auto thiz = shared_from_this();
         
         Any my_info;
-        std::map<std::string, Any> reduced_list;
+        Any::ObjectType reduced_list;
+        reduced_list.reserve(occupant_list.size());
         
-        for (const auto & id : Keys(occupant_list)) {
-            if (Some(id) == my_easyrtcid_) {
-                my_info = occupant_list[id];
+        for (const auto & entry : occupant_list) {
+            if (Some(entry.first.str()) == my_easyrtcid_) {
+                my_info = entry.second;
             }
             else {
-                reduced_list[id] = occupant_list[id];
+                reduced_list.insert(entry);
             }
             
         }
@@ -2756,8 +2748,8 @@ namespace ert {
             
             thiz->EmitEvent("roomOccupants", Any(Any::ObjectType
                                                  {
-                                                     { "roomName", Any(room_name) },
-                                                     { "occupants", Any(thiz->last_logged_in_list_) }
+                                                     { atoms::kRoomName, Any(room_name) },
+                                                     { Atom("occupants"), Any(thiz->last_logged_in_list_) }
                                                  }));
         }, Some(TimeDuration(0.1)));
     }
@@ -2786,23 +2778,23 @@ namespace ert {
             ack_acceptor_func(ack_message_);
         }
         
-        if (msg.GetAt("targetEasyrtcid")) {
-            targeting.SetAt("targetEasyrtcid", msg.GetAt("targetEasyrtcid"));
+        if (msg.GetAt(atoms::kTargetEasyrtcid)) {
+            targeting.SetAt(atoms::kTargetEasyrtcid, msg.GetAt(atoms::kTargetEasyrtcid));
         }
-        if (msg.GetAt("targetRoom")) {
-            targeting.SetAt("targetRoom", msg.GetAt("targetRoom"));
+        if (msg.GetAt(atoms::kTargetRoom)) {
+            targeting.SetAt(atoms::kTargetRoom, msg.GetAt(atoms::kTargetRoom));
         }
-        if (msg.GetAt("targetGroup")) {
-            targeting.SetAt("targetGroup", msg.GetAt("targetGroup"));
+        if (msg.GetAt(atoms::kTargetGroup)) {
+            targeting.SetAt(atoms::kTargetGroup, msg.GetAt(atoms::kTargetGroup));
         }
-        if (msg.GetAt("senderEasyrtcid")) {
-            ReceivePeerDistribute(msg.GetAt("senderEasyrtcid").AsString().value(),
+        if (msg.GetAt(atoms::kSenderEasyrtcid)) {
+            ReceivePeerDistribute(msg.GetAt(atoms::kSenderEasyrtcid).AsString().value(),
                                   msg, targeting);
         }
         else {
             if (receive_server_cb_){
-                receive_server_cb_(msg.GetAt("msgType").AsString().value(),
-                                   msg.GetAt("msgData"),
+                receive_server_cb_(msg.GetAt(atoms::kMsgType).AsString().value(),
+                                   msg.GetAt(atoms::kMsgData),
                                    targeting);
             }
             else {
@@ -2817,15 +2809,15 @@ namespace ert {
         printf("[OnChannelCmd] %s\n", msg.ToJsonString().c_str());
         auto thiz = shared_from_this();
         
-        Optional<std::string> caller = msg.GetAt("senderEasyrtcid").AsString();
-        std::string msg_type = msg.GetAt("msgType").AsString().value();
-        Any msg_data = msg.GetAt("msgData");
+        Optional<std::string> caller = msg.GetAt(atoms::kSenderEasyrtcid).AsString();
+        std::string msg_type = msg.GetAt(atoms::kMsgType).AsString().value();
+        Any msg_data = msg.GetAt(atoms::kMsgData);
         
         auto pc_ptr = std::make_shared<std::shared_ptr<RtcPeerConnection>>(nullptr);
         
         FuncCall(debug_printer_, std::string("received message of type ") + msg_type);
 
-        if (caller && HasKey(queued_messages_, *caller)) {
+        if (caller && HasKey(queued_messages_, Atom(*caller))) {
             ClearQueuedMessages(*caller);
         }
         
@@ -2871,12 +2863,12 @@ namespace ert {
         };
         
         auto flush_cached_candidates = [thiz, process_candidate_body](const std::string & caller) {
-            if (HasKey(thiz->queued_messages_, caller)) {
-                const auto candidates = thiz->queued_messages_[caller].GetAt("candidates").AsArray().value();
-                for (const auto & candidate : candidates) {
+            if (HasKey(thiz->queued_messages_, Atom(caller))) {
+                const Any candidates = thiz->queued_messages_[Atom(caller)].GetAt("candidates");
+                for (const auto & candidate : *candidates.AsArrayPointer()) {
                     process_candidate_body(caller, candidate);
                 }
-                thiz->queued_messages_.erase(caller);
+                thiz->queued_messages_.erase(Atom(caller));
             }
         };
         
@@ -2890,7 +2882,7 @@ namespace ert {
              const Optional<std::vector<std::string>> & stream_names)
             {
                 FuncCall(thiz->debug_printer_, nwr::Format("offer accept=%d", was_accepted));
-                thiz->offers_pending_.erase(caller);
+                thiz->offers_pending_.erase(Atom(caller));
                 
                 if (was_accepted) {
                     if (!thiz->SupportsPeerConnections()) {
@@ -2921,8 +2913,8 @@ namespace ert {
                 )
             {
                 thiz->acceptance_pending_.erase(caller);
-                if (HasKey(thiz->queued_messages_, caller)) {
-                    thiz->queued_messages_.erase(caller);
+                if (HasKey(thiz->queued_messages_, Atom(caller))) {
+                    thiz->queued_messages_.erase(Atom(caller));
                 }
                 FuncCall(thiz->peer_conns_[caller]->was_accepted_cb(), true, caller);
                 
@@ -2931,7 +2923,7 @@ namespace ert {
                 return;
             }
             
-            thiz->offers_pending_[caller] = msg_data;
+            thiz->offers_pending_[Atom(caller)] = msg_data;
             
             if (!thiz->accept_check_) {
                 helper(true, None());
@@ -2943,8 +2935,8 @@ namespace ert {
         
         auto process_reject = [thiz](const std::string & caller){
             thiz->acceptance_pending_.erase(caller);
-            if (HasKey(thiz->queued_messages_, caller)) {
-                thiz->queued_messages_.erase(caller);
+            if (HasKey(thiz->queued_messages_, Atom(caller))) {
+                thiz->queued_messages_.erase(Atom(caller));
             }
             if (HasKey(thiz->peer_conns_, caller)) {
                 FuncCall(thiz->peer_conns_[caller]->was_accepted_cb(), false, caller);
@@ -3009,18 +3001,19 @@ namespace ert {
             }
             else {
                 if (!HasKey(thiz->peer_conns_, caller)) {
-                    thiz->queued_messages_[caller] = Any(Any::ObjectType {
-                        { "candidates", Any(Any::ArrayType{}) }
+                    thiz->queued_messages_[Atom(caller)] = Any(Any::ObjectType {
+                        { Atom("candidates"), Any(Any::ArrayType{}) }
                     });
                 }
-                thiz->queued_messages_[caller].GetAt("candidates").AsArray()->push_back(msg_data);
+                Any candidates = thiz->queued_messages_[Atom(caller)].GetAt("candidates");
+                candidates.SetAt(candidates.count(), msg_data);
             }
         };
 
         if (msg_type == "sessionData") {
             ProcessSessionData(msg_data.GetAt("sessionData"));
         } else if (msg_type == "roomData") {
-            ProcessRoomData(msg_data.GetAt("roomData"));
+            ProcessRoomData(msg_data.GetAt(atoms::kRoomData));
         } else if (msg_type == "iceConfig") {
             ProcessIceConfig(msg_data.GetAt("iceConfig"));
         } else if (msg_type == "forwardToUrl") {
@@ -3037,8 +3030,8 @@ namespace ert {
             OnRemoteHangup(*caller);
             ClearQueuedMessages(*caller);
         } else if (msg_type == "error") {
-            ShowError(msg_data.GetAt("errorCode").AsString().value(),
-                      msg_data.GetAt("errorText").AsString().value());
+            ShowError(msg_data.GetAt(atoms::kErrorCode).AsString().value(),
+                      msg_data.GetAt(atoms::kErrorText).AsString().value());
         } else {
             printf("received unknown message type from server; msg=%s\n", msg.ToJsonString().c_str());
             return;
@@ -3113,7 +3106,27 @@ namespace ert {
             FuncCall(thiz->debug_printer_, "saw socket-server connect event");
             
             if (thiz->websocket_connected_) {
-                thiz->SendAuthenticate(success_callback, error_callback);
+                thiz->SendAuthenticate()
+                ->Then([thiz, success_callback, error_callback](const Any & msg) {
+                    if (msg.GetAt(atoms::kMsgType).AsString() == Some(std::string("error"))) {
+                        error_callback(msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorCode).AsString() || std::string(),
+                                       msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorText).AsString() || std::string());
+                        thiz->room_join_.clear();
+                        return;
+                    }
+                    
+                    thiz->ProcessToken(msg);
+                    
+                    for (const std::string & room : Keys(thiz->room_api_fields_)) {
+                        thiz->EnqueueSendRoomApi(room);
+                    }
+                    
+                    FuncCall(success_callback, thiz->my_easyrtcid_.value());
+                })
+                ->Catch([thiz, error_callback](const std::string & error) {
+                    error_callback(thiz->err_codes_CONNECT_ERR_,
+                                   thiz->GetConstantString("noServer"));
+                });
             }
             else {
                 error_callback(thiz->err_codes_SIGNAL_ERROR_,
@@ -3165,7 +3178,7 @@ namespace ert {
     
     Any Easyrtc::BuildDeltaRecord(const Any & added, const Any & deleted) {
         auto object_not_empty = [](const Any & obj){
-            return obj.keys().size() > 0;
+            return obj.count() > 0;
         };
         
         Any result(Any::ObjectType{});
@@ -3190,26 +3203,27 @@ namespace ert {
         Any added = Any(Any::ObjectType{});
         Any deleted = Any(Any::ObjectType{});
 //        var subPart;
-        for (const std::string & i : new_version.keys()) {
-            if (!old_version || !old_version.GetAt(i)) {
-                added.SetAt(i, new_version.GetAt(i));
+        new_version.ForEach([&](const std::string & i, const Any & new_value) {
+            Any old_value = old_version.GetAt(i);
+            if (!old_value) {
+                added.SetAt(i, new_value);
             }
-            else if (new_version.GetAt(i).type() == Any::Type::Object) {
-                Any sub_part = FindDeltas(old_version.GetAt(i), new_version.GetAt(i));
+            else if (new_value.type() == Any::Type::Object) {
+                Any sub_part = FindDeltas(old_value, new_value);
                 if (sub_part) {
-                    added.SetAt(i, new_version.GetAt(i));
+                    added.SetAt(i, new_value);
                 }
             }
-            else if (new_version.GetAt(i) != old_version.GetAt(i)) {
-                added.SetAt(i, new_version.GetAt(i));
+            else if (new_value != old_value) {
+                added.SetAt(i, new_value);
             }
-        }
+        });
         
-        for (const std::string & i : old_version.keys()) {
+        old_version.ForEach([&](const std::string & i, const Any & old_value) {
             if (!new_version.GetAt(i)) {
-                deleted.SetAt(i, old_version.GetAt(i));
+                deleted.SetAt(i, old_value);
             }
-        }
+        });
         
         return BuildDeltaRecord(added, deleted);
     }
@@ -3224,25 +3238,25 @@ namespace ert {
             }
             
             p2p_list.SetAt(i, Any(Any::ObjectType{
-                { "connectTime", connect_time_json },
-                { "isInitiator", Any(peer_conns_[i]->is_initiator()) }
+                { Atom("connectTime"), connect_time_json },
+                { Atom("isInitiator"), Any(peer_conns_[i]->is_initiator()) }
             }));
         }
 
         Any new_config(Any::ObjectType {
-            { "userSettings", Any(Any::ObjectType{
-                { "sharingAudio", Any(have_audio_) },
-                { "sharingVideo", Any(have_video_) },
-                { "sharingData", Any(data_enabled_) },
-                { "nativeVideoWidth", Any(640) },
-                { "nativeVideoHeight", Any(480) },
-                { "windowWidth", Any(320) },
-                { "windowHeight", Any(640) },
-                { "screenWidth", Any(320) },
-                { "screenHeight", Any(640) },
-                { "cookieEnabled", Any(false) },
-                { "os", Any("iOS") },
-                { "language", Any("ja") },
+            { Atom("userSettings"), Any(Any::ObjectType{
+                { Atom("sharingAudio"), Any(have_audio_) },
+                { Atom("sharingVideo"), Any(have_video_) },
+                { Atom("sharingData"), Any(data_enabled_) },
+                { Atom("nativeVideoWidth"), Any(640) },
+                { Atom("nativeVideoHeight"), Any(480) },
+                { Atom("windowWidth"), Any(320) },
+                { Atom("windowHeight"), Any(640) },
+                { Atom("screenWidth"), Any(320) },
+                { Atom("screenHeight"), Any(640) },
+                { Atom("cookieEnabled"), Any(false) },
+                { Atom("os"), Any("iOS") },
+                { Atom("language"), Any("ja") },
             }) }
         });
         
@@ -3274,7 +3288,7 @@ namespace ert {
                     thiz->SendSignaling(None(), "setUserCfg",
                                         Any(Any::ObjectType
                                             {
-                                                { "setUserCfg", altered_data.GetAt("added") }
+                                                { Atom("setUserCfg"), altered_data.GetAt("added") }
                                             }),
                                         nullptr, nullptr);
                 }
@@ -3303,20 +3317,20 @@ namespace ert {
         if (websocket_connected_) {
             SendSignaling(None(), "setPresence", Any(Any::ObjectType
                                                      {
-                                                         { "show", Any(state) },
-                                                         { "status", Any(status_text) }
+                                                         { Atom("show"), Any(state) },
+                                                         { Atom("status"), Any(status_text) }
                                                      }),
                           nullptr, nullptr);
         }
     }
     
-    std::map<std::string, Any> Easyrtc::GetSessionFields() {
+    Any::ObjectType Easyrtc::GetSessionFields() {
         return session_fields_;
     }
     
     Any Easyrtc::GetSessionField(const std::string & name) {
-        if (HasKey(session_fields_, name)) {
-            return session_fields_[name].GetAt("fieldValue");
+        if (HasKey(session_fields_, Atom(name))) {
+            return session_fields_[Atom(name)].GetAt("fieldValue");
         }
         else {
             return nullptr;
@@ -3328,19 +3342,21 @@ namespace ert {
             if (session_data.GetAt("easyrtcsid")) {
                 easyrtcsid_ = Some(session_data.GetAt("easyrtcsid").AsString().value());
             }
-            if (session_data.GetAt("field")) {
-                session_fields_ = session_data.GetAt("field").AsObject().value();
+            if (session_data.GetAt(atoms::kField)) {
+                session_fields_ = *PromoteFromArena(session_data.GetAt(atoms::kField)).AsObjectPointer();
             }
         }
     }
     
-    void Easyrtc::ProcessRoomData(const Any & room_data) {
-        room_data_ = room_data.AsObject().value();
+    void Easyrtc::ProcessRoomData(const Any & arg_room_data) {
+        //  kept in members, so take it out of the packet arena
+        Any room_data = PromoteFromArena(arg_room_data);
+        room_data_ = *room_data.AsObjectPointer();
         
-        for (const auto & room_name : Keys(room_data_)) {
-            if (room_data_[room_name].GetAt("roomStatus").AsString() == Some(std::string("join"))) {
-                if (!HasKey(room_join_, room_name)) {
-                    room_join_[room_name] = room_data_[room_name];
+        room_data.ForEach([&](const std::string & room_name, const Any & room) {
+            if (room.GetAt(atoms::kRoomStatus).AsString() == Some(std::string("join"))) {
+                if (!HasKey(room_join_, Atom(room_name))) {
+                    room_join_[Atom(room_name)] = room;
                 }
                 
                 auto media_ids = BuildMediaIds();
@@ -3348,62 +3364,63 @@ namespace ert {
                     SetRoomApiField(room_name, "mediaIds", Any(media_ids));
                 }
             }
-            else if (room_data_[room_name].GetAt("roomStatus").AsString() == Some(std::string("leave"))) {
+            else if (room.GetAt(atoms::kRoomStatus).AsString() == Some(std::string("leave"))) {
                 FuncCall(room_entry_listener_, false, room_name);
-                room_join_.erase(room_name);
-                last_logged_in_list_.erase(room_name);
-                continue;
+                room_join_.erase(Atom(room_name));
+                last_logged_in_list_.erase(Atom(room_name));
+                return;
             }
             
-            if (room_data_[room_name].GetAt("clientList")) {
-                last_logged_in_list_[room_name] = room_data_[room_name].GetAt("clientList");
+            if (room.GetAt(atoms::kClientList)) {
+                last_logged_in_list_[Atom(room_name)] = room.GetAt(atoms::kClientList);
             }
-            else if (room_data_[room_name].GetAt("clientListDelta")) {
-                auto stuff_to_add = room_data_[room_name].GetAt("clientListDelta").GetAt("updateClient");
+            else if (room.GetAt(atoms::kClientListDelta)) {
+                auto stuff_to_add = room.GetAt(atoms::kClientListDelta).GetAt("updateClient");
                 if (stuff_to_add) {
-                    for (const std::string & id : stuff_to_add.keys()) {
-                        if (!HasKey(last_logged_in_list_, room_name)) {
-                            last_logged_in_list_[room_name] = Any(Any::ObjectType{});
+                    stuff_to_add.ForEach([&](const std::string & id, const Any & client) {
+                        if (!HasKey(last_logged_in_list_, Atom(room_name))) {
+                            last_logged_in_list_[Atom(room_name)] = Any(Any::ObjectType{});
                         }
-                        if( !last_logged_in_list_[room_name].HasKey(id) ) {
-                            last_logged_in_list_[room_name].SetAt(id, stuff_to_add.GetAt(id));
+                        if( !last_logged_in_list_[Atom(room_name)].HasKey(id) ) {
+                            last_logged_in_list_[Atom(room_name)].SetAt(id, client);
                         }
-                        for (const std::string & k : stuff_to_add.GetAt(id).keys()) {
+                        Any occupant = last_logged_in_list_[Atom(room_name)].GetAt(id);
+                        client.ForEach([&](const std::string & k, const Any & value) {
                             if( k == "apiField" || k == "presence") {
-                                last_logged_in_list_[room_name].GetAt(id).SetAt(k, stuff_to_add.GetAt(id).GetAt(k));
+                                occupant.SetAt(k, value);
                             }
-                        }
-                    }
+                        });
+                    });
                 }
-                auto stuff_to_remove = room_data_[room_name].GetAt("clientListDelta").GetAt("removeClient");
-                if (stuff_to_remove && HasKey(last_logged_in_list_, room_name)) {
-                    for (const std::string & remove_id : stuff_to_remove.keys()) {
-                        last_logged_in_list_[room_name].RemoveAt(remove_id);
-                    }
+                auto stuff_to_remove = room.GetAt(atoms::kClientListDelta).GetAt("removeClient");
+                if (stuff_to_remove && HasKey(last_logged_in_list_, Atom(room_name))) {
+                    stuff_to_remove.ForEach([&](const std::string & remove_id, const Any &) {
+                        last_logged_in_list_[Atom(room_name)].RemoveAt(remove_id);
+                    });
                 }
             }
-            if (HasKey(room_join_, room_name) && room_data_[room_name].GetAt("field")) {
-                fields_.rooms[room_name] = room_data_[room_name].GetAt("field").AsObject().value();
+            if (HasKey(room_join_, Atom(room_name)) && room.GetAt(atoms::kField)) {
+                fields_.rooms[room_name] = *room.GetAt(atoms::kField).AsObjectPointer();
             }
-            if (room_data_[room_name].GetAt("roomStatus").AsString() == Some(std::string("join"))) {
+            if (room.GetAt(atoms::kRoomStatus).AsString() == Some(std::string("join"))) {
                 FuncCall(room_entry_listener_, true, room_name);
             }
-            ProcessOccupantList(room_name, last_logged_in_list_[room_name].AsObject().value());
-        }
+            ProcessOccupantList(room_name, *last_logged_in_list_[Atom(room_name)].AsObjectPointer());
+        });
         EmitEvent("roomOccupant", Any(last_logged_in_list_));
     }
     
     std::vector<std::string> Easyrtc::GetRoomOccupantsAsArray(const std::string & room_name) {
-        if (!HasKey(last_logged_in_list_, room_name)) {
+        if (!HasKey(last_logged_in_list_, Atom(room_name))) {
             return {};
         }
         else {
-            return last_logged_in_list_[room_name].keys();
+            return last_logged_in_list_[Atom(room_name)].keys();
         }
     }
     
-    std::map<std::string, Any> Easyrtc::GetRoomOccupantsAsMap(const std::string & room_name) {
-        return last_logged_in_list_[room_name].AsObject().value();
+    Any::ObjectType Easyrtc::GetRoomOccupantsAsMap(const std::string & room_name) {
+        return last_logged_in_list_[Atom(room_name)].AsObject().value();
     }
     
     bool Easyrtc::IsTurnServer(const std::string & ip_address) {
@@ -3423,7 +3440,7 @@ namespace ert {
         {
             ShowError(err_codes_DEVELOPER_ERR_, "iceConfig received from server didn't have an array called iceServers, ignoring it");
             ice_config = Any(Any::ObjectType{
-                { "iceServers", Any(Any::ArrayType{}) }
+                { Atom("iceServers"), Any(Any::ArrayType{}) }
             });
         }
         
@@ -3459,41 +3476,36 @@ namespace ert {
         }
     }
     
-    void Easyrtc::GetFreshIceConfig(const std::function<void (bool)> & arg_callback) {
+    PromisePtr<None> Easyrtc::GetFreshIceConfig() {
         auto thiz = shared_from_this();
-        auto callback = arg_callback;
         Any data_to_ship(Any::ObjectType{
-            { "msgType", Any("getIceConfig") },
-            { "msgData", Any(Any::ObjectType{})}
+            { atoms::kMsgType, Any("getIceConfig") },
+            { atoms::kMsgData, Any(Any::ObjectType{})}
         });
-        if (!callback) {
-            callback = [](bool v){};
-        }
-        websocket_->JsonEmit("easyrtcCmd", {
-            data_to_ship,
-            AnyFuncMake([thiz, callback](const Any & ack_msg) {
-                if (ack_msg.GetAt("msgType").AsString() == Some(std::string("iceConfig"))) {
-                    thiz->ProcessIceConfig(ack_msg.GetAt("msgData").GetAt("iceConfig"));
-                    callback(true);
+        return websocket_->JsonEmitWithAck("easyrtcCmd", { data_to_ship })
+        ->Then([thiz](const Any & ack_msg) {
+                if (ack_msg.GetAt(atoms::kMsgType).AsString() == Some(std::string("iceConfig"))) {
+                    thiz->ProcessIceConfig(ack_msg.GetAt(atoms::kMsgData).GetAt("iceConfig"));
+                return Promise<None>::Resolved(None());
                 }
                 else {
-                    thiz->ShowError(ack_msg.GetAt("msgData").GetAt("errorCode").AsString() || std::string(),
-                                    ack_msg.GetAt("msgData").GetAt("errorText").AsString() || std::string());
-                    callback(false);
+                std::string error_text = ack_msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorText).AsString() || std::string();
+                    thiz->ShowError(ack_msg.GetAt(atoms::kMsgData).GetAt(atoms::kErrorCode).AsString() || std::string(),
+                                error_text);
+                return Promise<None>::Rejected(error_text);
                 }
-            })
         });
     }
     
     void Easyrtc::ProcessToken(const Any & msg) {
         FuncCall(debug_printer_, "entered process token");
         
-        auto msg_data = msg.GetAt("msgData");
-        if (msg_data.HasKey("easyrtcid")) {
-            my_easyrtcid_ = Some(msg_data.GetAt("easyrtcid").AsString().value());
+        auto msg_data = msg.GetAt(atoms::kMsgData);
+        if (msg_data.HasKey(atoms::kEasyrtcid)) {
+            my_easyrtcid_ = Some(msg_data.GetAt(atoms::kEasyrtcid).AsString().value());
         }
-        if (msg_data.HasKey("field")) {
-            fields_.connection = msg_data.GetAt("field").AsObject().value();
+        if (msg_data.HasKey(atoms::kField)) {
+            fields_.connection = *PromoteFromArena(msg_data.GetAt(atoms::kField)).AsObjectPointer();
         }
         if (msg_data.HasKey("iceConfig")) {
             ProcessIceConfig(msg_data.GetAt("iceConfig"));
@@ -3501,35 +3513,31 @@ namespace ert {
         if (msg_data.HasKey("sessionData")) {
             ProcessSessionData(msg_data.GetAt("sessionData"));
         }
-        if (msg_data.HasKey("roomData")) {
-            ProcessRoomData(msg_data.GetAt("roomData"));
+        if (msg_data.HasKey(atoms::kRoomData)) {
+            ProcessRoomData(msg_data.GetAt(atoms::kRoomData));
         }
-        if (msg_data.GetAt("application").HasKey("field")) {
-            fields_.application = msg_data.GetAt("application").GetAt("field").AsObject().value();
+        if (msg_data.GetAt("application").HasKey(atoms::kField)) {
+            fields_.application = *PromoteFromArena(msg_data.GetAt("application").GetAt(atoms::kField)).AsObjectPointer();
         }
     }
     
-    void Easyrtc::SendAuthenticate(const std::function<void (const std::string &)> & success_callback,
-                                   const std::function<void (const std::string &,
-                                                             const std::string &)> & error_callback)
-    {
-        auto thiz = shared_from_this();
+    PromisePtr<Any> Easyrtc::SendAuthenticate() {
         //
         // find our easyrtcsid
         //
         easyrtcsid_ = None();
 
         Any msg_data(Any::ObjectType{
-            { "apiVersion", Any(api_version_) },
-            { "applicationName", Any(application_name_) },
-            { "setUserCfg", CollectConfigurationInfo(true) }
+            { Atom("apiVersion"), Any(api_version_) },
+            { Atom("applicationName"), Any(application_name_) },
+            { Atom("setUserCfg"), CollectConfigurationInfo(true) }
         });
         
         if (presence_show_) {
             msg_data.SetAt("setPresence", Any(Any::ObjectType
                                               {
-                                                  { "show", Any(presence_show_.value()) },
-                                                  { "status", Any(presence_status_.value()) }
+                                                  { Atom("show"), Any(presence_show_.value()) },
+                                                  { Atom("status"), Any(presence_status_.value()) }
                                               }));
         }
         if (username_) {
@@ -3547,29 +3555,12 @@ namespace ert {
         
         printf("%s\n", msg_data.ToJsonString().c_str());
         
-        websocket_->JsonEmit("easyrtcAuth",
+        return websocket_->JsonEmitWithAck("easyrtcAuth",
                          {
                              Any(Any::ObjectType
                                {
-                                   { "msgType", Any("authenticate") },
-                                   { "msgData", msg_data }
-                               }),
-                             AnyFuncMake([thiz, success_callback, error_callback](const Any & msg) {
-                                 if (msg.GetAt("msgType").AsString() == Some(std::string("error"))) {
-                                     
-                                     error_callback(msg.GetAt("msgData").GetAt("errorCode").AsString() || std::string(),
-                                                    msg.GetAt("msgData").GetAt("errorText").AsString() || std::string());
-                                     thiz->room_join_.clear();
-                                 }
-                                 else {
-                                     thiz->ProcessToken(msg);
-                                     
-                                     for (const std::string & room : Keys(thiz->room_api_fields_)) {
-                                         thiz->EnqueueSendRoomApi(room);
-                                     }
-                                     
-                                     FuncCall(success_callback, thiz->my_easyrtcid_.value());
-                                 }
+                                   { atoms::kMsgType, Any("authenticate") },
+                                   { atoms::kMsgData, msg_data }
                              })
                          });
     }
@@ -3582,15 +3573,15 @@ namespace ert {
         return rooms_in;
     }
     
-    std::map<std::string, Any> Easyrtc::GetRoomFields(const std::string & room_name) {
+    Any::ObjectType Easyrtc::GetRoomFields(const std::string & room_name) {
         return fields_.rooms[room_name];
     }
     
-    std::map<std::string, Any> Easyrtc::GetApplicationFields() {
+    Any::ObjectType Easyrtc::GetApplicationFields() {
         return fields_.application;
     }
     
-    std::map<std::string, Any> Easyrtc::GetConnectionFields() {
+    Any::ObjectType Easyrtc::GetConnectionFields() {
         return fields_.connection;
     }
     
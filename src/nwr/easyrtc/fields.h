@@ -16,9 +16,9 @@ namespace nwr {
 namespace ert {
     struct Fields {
         void Clear();
-        std::map<std::string, std::map<std::string, Any>> rooms;
-        std::map<std::string, Any> application;
-        std::map<std::string, Any> connection;
+        std::map<std::string, Any::ObjectType> rooms;
+        Any::ObjectType application;
+        Any::ObjectType connection;
     };
 }
 }
@@ -39,46 +39,35 @@ namespace eio {
         return 0 <= type && type <= static_cast<int>(PacketType::Noop);
     }
     
-    PacketData::PacketData(){}
+    PacketData::PacketData():
+    binary(false){}
     
     PacketData::PacketData(const Data & data):
     PacketData(std::make_shared<Data>(data)){}
     
-    PacketData::PacketData(const DataPtr & data): binary(data){}
+    PacketData::PacketData(const DataPtr & data):
+    binary(true), slice(data){}
     
     PacketData::PacketData(const std::string & data):
-    PacketData(std::make_shared<std::string>(data)){}
+    PacketData(AsDataPointer(data), static_cast<int>(data.size()), false){}
     
-    PacketData::PacketData(const std::shared_ptr<std::string> & data): text(data){}
+    PacketData::PacketData(const std::shared_ptr<std::string> & data):
+    PacketData(*data){}
     
-    PacketData::PacketData(const uint8_t * ptr, int size, bool binary) {
-        if (binary) {
-            this->binary = std::make_shared<Data>(ptr, ptr + size);
-        } else {
-            this->text = std::make_shared<std::string>(reinterpret_cast<const char *>(ptr), size);
-        }
-    }
+    PacketData::PacketData(const uint8_t * ptr, int size, bool binary):
+    binary(binary), slice(std::make_shared<Data>(ptr, ptr + size)){}
+    
+    PacketData::PacketData(const BufferSlice & slice, bool binary):
+    binary(binary), slice(slice){}
     
     const uint8_t * PacketData::ptr() const {
-        if (binary) {
-            return &(*binary)[0];
-        } else {
-            return reinterpret_cast<const uint8_t *>(&(*text)[0]);
-        }
+        return slice.ptr();
     }
     const char * PacketData::char_ptr() const {
-        if (binary) {
-            return reinterpret_cast<const char *>(&(*binary)[0]);
-        } else {
-            return &(*text)[0];
-        }
+        return slice.char_ptr();
     }
     int PacketData::size() const {
-        if (binary) {
-            return static_cast<int>(binary->size());
-        } else {
-            return static_cast<int>(text->size());
-        }
+        return slice.size();
     }
 
 }
@@ -38,9 +38,11 @@ namespace eio {
         explicit PacketData(const std::string & data);
         explicit PacketData(const std::shared_ptr<std::string> & data);
         PacketData(const uint8_t * ptr, int size, bool binary);
+        PacketData(const BufferSlice & slice, bool binary);
         
-        DataPtr binary;
-        std::shared_ptr<std::string> text;
+        bool binary;
+        //  may share the buffer of the received frame
+        BufferSlice slice;
         
         const uint8_t * ptr() const;
         const char * char_ptr() const;
@@ -24,22 +24,25 @@ namespace eio {
             return EncodeBuffer(packet);
         }
         
-        std::string encoded;
-        encoded += PacketTypeToChar(packet.type);
-        encoded += *packet.data.text;
-        return Websocket::Message(encoded);
+        //  written into the final send buffer
+        auto message = Websocket::Message::Allocate(Websocket::Message::Mode::Text, 1 + packet.data.size());
+        uint8_t * encoded = message.mutable_ptr();
+        encoded[0] = static_cast<uint8_t>(PacketTypeToChar(packet.type));
+        std::copy(packet.data.ptr(), packet.data.ptr() + packet.data.size(), encoded + 1);
+        return message;
     }
     
     Websocket::Message EncodeBuffer(const Packet & packet) {
-        auto data = Data();
-        data.insert(data.end(), static_cast<uint8_t>(packet.type));
-        data.insert(data.end(), packet.data.binary->begin(), packet.data.binary->end());
-        return Websocket::Message(data);
+        auto message = Websocket::Message::Allocate(Websocket::Message::Mode::Binary, 1 + packet.data.size());
+        uint8_t * encoded = message.mutable_ptr();
+        encoded[0] = static_cast<uint8_t>(packet.type);
+        std::copy(packet.data.ptr(), packet.data.ptr() + packet.data.size(), encoded + 1);
+        return message;
     }
     
     Packet DecodePacket(const Websocket::Message & message)
     {
-        auto & data = *message.data;
+        auto & data = message.data;
         
         if (data.size() == 0) {
             return MakeParserErrorPacket("message size is empty");
@@ -49,7 +52,7 @@ namespace eio {
             char type_char = data[0];
             
             if (type_char == 'b'){
-                return DecodeBase64Packet(Websocket::Message(Data(data.begin() + 1, data.end())));
+                return DecodeBase64Packet(Websocket::Message(Websocket::Message::Mode::Text, data.Slice(1)));
             }
             
             uint8_t type = type_char - '0';
@@ -58,9 +61,7 @@ namespace eio {
                 return MakeParserErrorPacket(Format("invalid packet type: %d", type));
             }
             
-            auto packet_data = std::make_shared<std::string>(reinterpret_cast<const char *>(&data[1]),
-                                                             data.size() - 1);
-            return { static_cast<PacketType>(type), PacketData(packet_data) };
+            return { static_cast<PacketType>(type), PacketData(data.Slice(1), false) };
         } else {
             uint8_t type = data[0];
             
@@ -68,13 +69,12 @@ namespace eio {
                 return MakeParserErrorPacket(Format("invalid packet type: %d", type));
             }
             
-            return { static_cast<PacketType>(type),
-                PacketData(std::make_shared<Data>(data.begin() + 1, data.end())) };
+            return { static_cast<PacketType>(type), PacketData(data.Slice(1), true) };
         }
     }
     
     Packet DecodeBase64Packet(const Websocket::Message & message) {
-        auto & data = *message.data;
+        auto & data = message.data;
         if (data.size() == 0) {
             return MakeParserErrorPacket("message size is empty");
         }
@@ -84,11 +84,12 @@ namespace eio {
             return MakeParserErrorPacket(Format("invalid packet type: %d", type));
         }
         
-        Data data2;
-        Base64Decode(Data(data.begin() + 1, data.end()), data2);
+        auto decoded = std::make_shared<Data>();
+        if (!Base64Decode(data.Slice(1), *decoded)) {
+            return MakeParserErrorPacket("invalid base64 data");
+        }
         
-        return { static_cast<PacketType>(type),
-            PacketData(std::make_shared<Data>(std::move(data2))) };
+        return { static_cast<PacketType>(type), PacketData(decoded) };
     }
 
 }
@@ -20,6 +20,9 @@ namespace eio {
     agent(),
     timestamp_param("t"),
     timestamp_requests(false),
+    per_message_deflate(false),
+    buffered_amount_high_watermark(Websocket::Options().buffered_amount_high_watermark),
+    buffered_amount_low_watermark(Websocket::Options().buffered_amount_low_watermark),
     
     reconnection(true),
     reconnection_attempts(-1),
@@ -28,6 +31,8 @@ namespace eio {
     randomization_factor(0.5),
     timeout(TimeDuration(20.0)),
     auto_connect(true),
+    decode_on_worker(false),
+    decode_to_arena(false),
     
     force_new(false),
     multiplex(true)
@@ -50,6 +55,7 @@ namespace eio {
     ping_emitter_(std::make_shared<decltype(ping_emitter_)::element_type>()),
     drain_emitter_(std::make_shared<decltype(drain_emitter_)::element_type>()),
     flush_emitter_(std::make_shared<decltype(flush_emitter_)::element_type>()),
+    congested_emitter_(std::make_shared<decltype(congested_emitter_)::element_type>()),
     packet_create_emitter_(std::make_shared<decltype(packet_create_emitter_)::element_type>()),
     error_emitter_(std::make_shared<decltype(error_emitter_)::element_type>()),
     close_emitter_(std::make_shared<decltype(close_emitter_)::element_type>())
@@ -78,6 +84,10 @@ namespace eio {
         
         timestamp_param_ = params.timestamp_param;
         timestamp_requests_ = params.timestamp_requests;
+        per_message_deflate_ = params.per_message_deflate;
+        buffered_amount_high_watermark_ = params.buffered_amount_high_watermark;
+        buffered_amount_low_watermark_ = params.buffered_amount_low_watermark;
+        transport_factory_ = params.transport_factory;
         
         ready_state_ = ReadyState::None;
         
@@ -119,7 +129,13 @@ namespace eio {
         p.timestamp_requests = timestamp_requests_;
         p.origin = origin_;
         p.agent = agent_;
+        p.per_message_deflate = per_message_deflate_;
+        p.buffered_amount_high_watermark = buffered_amount_high_watermark_;
+        p.buffered_amount_low_watermark = buffered_amount_low_watermark_;
         
+        if (transport_factory_) {
+            return transport_factory_(name, p);
+        }
         return Transport::Create(name, p);
     }
     
@@ -135,6 +151,16 @@ namespace eio {
         set_transport(transport);
     }
     
+    int64_t Socket::buffered_amount() {
+        if (!transport_) { return 0; }
+        return transport_->buffered_amount();
+    }
+    
+    Websocket::Stats Socket::stats() {
+        if (!transport_) { return Websocket::Stats(); }
+        return transport_->stats();
+    }
+    
     void Socket::set_transport(const std::shared_ptr<Transport> & transport) {
         if (transport_) {
             printf("clearing existing transport %s\n", transport_->name().c_str());
@@ -150,6 +176,9 @@ namespace eio {
         transport_->drain_emitter()->On([thiz](None _){
             thiz->OnDrain();
         });
+        transport_->congested_emitter()->On([thiz](None _){
+            thiz->congested_emitter_->Emit(None());
+        });
         transport_->packet_emitter()->On([thiz](const Packet & packet){
             thiz->OnPacket(packet);
         });
@@ -20,10 +20,12 @@
 #include <nwr/base/time.h>
 #include <nwr/base/emitter.h>
 #include <nwr/base/json.h>
+#include <nwr/base/websocket.h>
 
 #include "optional.h"
 #include "parser.h"
 #include "timer.h"
+#include "transport.h"
 
 namespace nwr {
 namespace eio {
@@ -41,6 +43,13 @@ namespace eio {
             Optional<std::string> path;
             std::string timestamp_param;
             bool timestamp_requests;
+            bool per_message_deflate;
+            int64_t buffered_amount_high_watermark;
+            int64_t buffered_amount_low_watermark;
+            //  creates the transport instead of Transport::Create when set,
+            //  for a scripted server in tests
+            std::function<std::shared_ptr<Transport>(const std::string & name,
+                                                     const Transport::ConstructorParams & params)> transport_factory;
             
             //  socket.io
             bool reconnection;
@@ -50,6 +59,10 @@ namespace eio {
             double randomization_factor;
             TimeDuration timeout;
             bool auto_connect;
+            //  parses the received packets on WorkerPool::shared()
+            bool decode_on_worker;
+            //  builds the decoded packets in an AnyArena per packet
+            bool decode_to_arena;
             
             //  socket.io; io()
             bool force_new;
@@ -80,11 +93,16 @@ namespace eio {
         EmitterPtr<None> ping_emitter() { return ping_emitter_; }
         EmitterPtr<None> drain_emitter() { return drain_emitter_; }
         EmitterPtr<None> flush_emitter() { return flush_emitter_; }
+        //  the transport buffers over its high watermark; hold sends until drain
+        EmitterPtr<None> congested_emitter() { return congested_emitter_; }
         EmitterPtr<Packet> packet_create_emitter() { return packet_create_emitter_; }
         EmitterPtr<Error> error_emitter() { return error_emitter_; }
         EmitterPtr<None> close_emitter() { return close_emitter_; }
         
         std::string id() { return id_; }
+        //  bytes in the transport not yet written, not counting the write buffer
+        int64_t buffered_amount();
+        Websocket::Stats stats();
     private:
         std::shared_ptr<Transport> CreateTransport(const std::string & name);
         
@@ -124,6 +142,11 @@ namespace eio {
         std::string agent_;
         std::string timestamp_param_;
         bool timestamp_requests_;
+        bool per_message_deflate_;
+        int64_t buffered_amount_high_watermark_;
+        int64_t buffered_amount_low_watermark_;
+        std::function<std::shared_ptr<Transport>(const std::string & name,
+                                                 const Transport::ConstructorParams & params)> transport_factory_;
         ReadyState ready_state_;
         std::vector<Packet> write_buffer_;
         std::shared_ptr<Transport> transport_;
@@ -144,6 +167,7 @@ namespace eio {
         EmitterPtr<None> ping_emitter_;
         EmitterPtr<None> drain_emitter_;
         EmitterPtr<None> flush_emitter_;
+        EmitterPtr<None> congested_emitter_;
         EmitterPtr<Packet> packet_create_emitter_;
         EmitterPtr<Error> error_emitter_;
         EmitterPtr<None> close_emitter_;
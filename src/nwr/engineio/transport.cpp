@@ -22,7 +22,10 @@ namespace eio {
     timestamp_param(),
     timestamp_requests(),
     origin(),
-    agent()
+    agent(),
+    per_message_deflate(false),
+    buffered_amount_high_watermark(Websocket::Options().buffered_amount_high_watermark),
+    buffered_amount_low_watermark(Websocket::Options().buffered_amount_low_watermark)
     {}
     
     Transport::Transport(const ConstructorParams & params):
@@ -31,7 +34,8 @@ namespace eio {
     packet_emitter_(std::make_shared<decltype(packet_emitter_)::element_type>()),
     close_emitter_(std::make_shared<decltype(close_emitter_)::element_type>()),
     flush_emitter_(std::make_shared<decltype(flush_emitter_)::element_type>()),
-    drain_emitter_(std::make_shared<decltype(drain_emitter_)::element_type>())
+    drain_emitter_(std::make_shared<decltype(drain_emitter_)::element_type>()),
+    congested_emitter_(std::make_shared<decltype(congested_emitter_)::element_type>())
     {
         path_ = params.path;
         hostname_ = params.hostname;
@@ -43,6 +47,9 @@ namespace eio {
         ready_state_ = ReadyState::None;
         origin_ = params.origin;
         agent_ = params.agent;
+        per_message_deflate_ = params.per_message_deflate;
+        buffered_amount_high_watermark_ = params.buffered_amount_high_watermark;
+        buffered_amount_low_watermark_ = params.buffered_amount_low_watermark;
         
         writable_ = false;
     }
@@ -58,7 +65,7 @@ namespace eio {
     }
     
     Transport::~Transport() {
-        if (ready_state_ != ReadyState::Closed || ready_state_ != ReadyState::None) {
+        if (ready_state_ != ReadyState::Closed && ready_state_ != ReadyState::None) {
             Fatal("not closed");
         }
     }
@@ -82,6 +89,7 @@ namespace eio {
         close_emitter_->RemoveAllListeners();
         flush_emitter_->RemoveAllListeners();
         drain_emitter_->RemoveAllListeners();
+        congested_emitter_->RemoveAllListeners();
     }
     
     void Transport::Close() {
@@ -39,6 +39,9 @@ namespace eio {
             bool timestamp_requests;
             std::string origin;
             std::string agent;
+            bool per_message_deflate;
+            int64_t buffered_amount_high_watermark;
+            int64_t buffered_amount_low_watermark;
         };
         enum class ReadyState {
             None,
@@ -58,8 +61,14 @@ namespace eio {
         EmitterPtr<None> close_emitter() { return close_emitter_; }
         EmitterPtr<None> flush_emitter() { return flush_emitter_; }
         EmitterPtr<None> drain_emitter() { return drain_emitter_; }
+        //  the connection buffers over its high watermark; drain follows once it is low
+        EmitterPtr<None> congested_emitter() { return congested_emitter_; }
         
         virtual std::string name() = 0;
+        //  bytes sent and not yet written to the connection
+        virtual int64_t buffered_amount() { return 0; }
+        //  metrics of the underlying connection
+        virtual Websocket::Stats stats() { return Websocket::Stats(); }
         QueryStringParams & query_ref() { return query_; }
         bool writable() { return writable_; }
         
@@ -90,6 +99,9 @@ namespace eio {
         ReadyState ready_state_;
         std::string origin_;
         std::string agent_;
+        bool per_message_deflate_;
+        int64_t buffered_amount_high_watermark_;
+        int64_t buffered_amount_low_watermark_;
         
         bool writable_;
         
@@ -99,6 +111,7 @@ namespace eio {
         EmitterPtr<None> close_emitter_;
         EmitterPtr<None> flush_emitter_;
         EmitterPtr<None> drain_emitter_;
+        EmitterPtr<None> congested_emitter_;
     };
     
 }
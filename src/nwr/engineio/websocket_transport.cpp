@@ -14,14 +14,19 @@ namespace nwr {
 namespace eio {
     
     WebsocketTransport::WebsocketTransport(const Transport::ConstructorParams & params):
-    Transport(params){
+    Transport(params),
+    congested_(false){
         
     }
     
     void WebsocketTransport::DoOpen() {
         auto uri = this->uri();
         
-        ws_ = Websocket::Create(uri, origin_);
+        Websocket::Options options;
+        options.per_message_deflate = per_message_deflate_;
+        options.buffered_amount_high_watermark = buffered_amount_high_watermark_;
+        options.buffered_amount_low_watermark = buffered_amount_low_watermark_;
+        ws_ = Websocket::Create(uri, origin_, nullptr, options);
         
         AddEventListeners();
     }
@@ -39,6 +44,27 @@ namespace eio {
         ws_->set_on_error([this](const std::string & error){
             OnError(Format("websocket error: %s", error.c_str()));
         });
+        ws_->set_on_buffered_amount_high([this](int64_t){
+            congested_ = true;
+            congested_emitter_->Emit(None());
+        });
+        ws_->set_on_buffered_amount_low([this](int64_t){
+            congested_ = false;
+            if (!writable_) {
+                writable_ = true;
+                drain_emitter_->Emit(None());
+            }
+        });
+    }
+    
+    int64_t WebsocketTransport::buffered_amount() {
+        if (!ws_) { return 0; }
+        return ws_->buffered_amount();
+    }
+    
+    Websocket::Stats WebsocketTransport::stats() {
+        if (!ws_) { return closed_stats_; }
+        return ws_->stats();
     }
     
     std::string WebsocketTransport::uri() {
@@ -78,16 +104,23 @@ namespace eio {
         // encodePacket efficient as it uses WS framing
         // no need for encodePayload
         for (auto packet : packets) {
-            auto message = EncodePacket(packet);
-            
-            ws_->Send(message);
+            ws_->Send(EncodePacket(packet));
         }
         
         flush_emitter_->Emit(None());
         
+        //  a congested connection drains on its low watermark instead
+        if (congested_) {
+            return;
+        }
+        
         // fake drain
         // defer to next tick to allow Socket to clear writeBuffer
         timer_pool_.SetTimeout(TimeDuration(0), [this]{
+            //  the high watermark of this write is posted, so it may have come since
+            if (congested_) {
+                return;
+            }
             writable_ = true;
             drain_emitter_->Emit(None());
         });
@@ -96,6 +129,7 @@ namespace eio {
     void WebsocketTransport::DoClose() {
         if (ws_) {
             ws_->Close();
+            closed_stats_ = ws_->stats();
             ws_ = nullptr;
         }
     }
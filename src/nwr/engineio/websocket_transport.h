@@ -23,7 +23,9 @@ namespace eio {
         WebsocketTransport(const Transport::ConstructorParams & params);
         virtual ~WebsocketTransport() {}
         
-        virtual std::string name() { return "websocket"; }        
+        virtual std::string name() { return "websocket"; }
+        virtual int64_t buffered_amount();
+        virtual Websocket::Stats stats();
     protected:
         
         virtual void DoOpen();
@@ -35,6 +37,10 @@ namespace eio {
     private:
         
         std::shared_ptr<Websocket> ws_;
+        //  drain waits for on_buffered_amount_low while set
+        bool congested_;
+        //  of ws_ when it was closed
+        Websocket::Stats closed_stats_;
         
         TimerPool timer_pool_;
         
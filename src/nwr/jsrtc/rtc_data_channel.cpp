@@ -70,7 +70,7 @@ namespace jsrtc {
     }
     
     void RtcDataChannel::Send(const eio::PacketData & data) {
-        webrtc::DataBuffer wdata(rtc::Buffer(data.ptr(), data.size()), data.binary != nullptr);
+        webrtc::DataBuffer wdata(rtc::Buffer(data.ptr(), data.size()), data.binary);
         inner_channel_->Send(wdata);
     }
     
@@ -40,9 +40,9 @@ namespace jsrtc {
     
     Any RtcIceCandidate::ToAny() const {
         return Any(Any::ObjectType {
-            { "sdpMid", Any(sdp_mid_) },
-            { "sdpMLineIndex", Any(sdp_mline_index_) },
-            { "candidate", Any(candidate_) },
+            { Atom("sdpMid"), Any(sdp_mid_) },
+            { Atom("sdpMLineIndex"), Any(sdp_mline_index_) },
+            { Atom("candidate"), Any(candidate_) },
         });
     }
     std::shared_ptr<RtcIceCandidate> RtcIceCandidate::FromAny(const Any & any) {
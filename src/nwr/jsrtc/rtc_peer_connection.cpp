@@ -75,6 +75,48 @@ namespace jsrtc {
         inner_connection_->SetLocalDescription(observer.get(), wdesc);
     }
     
+    PromisePtr<std::shared_ptr<RtcSessionDescription>> RtcPeerConnection::
+    CreateOffer(const std::shared_ptr<MediaTrackConstraints> & options)
+    {
+        auto promise = Promise<std::shared_ptr<RtcSessionDescription>>::Create();
+        CreateOffer(options,
+                    [promise](const std::shared_ptr<RtcSessionDescription> & description) {
+                        promise->Resolve(description);
+                    },
+                    [promise](const std::string & error) {
+                        promise->Reject(error);
+                    });
+        return promise;
+    }
+    
+    PromisePtr<std::shared_ptr<RtcSessionDescription>> RtcPeerConnection::
+    CreateAnswer(const std::shared_ptr<MediaTrackConstraints> & options)
+    {
+        auto promise = Promise<std::shared_ptr<RtcSessionDescription>>::Create();
+        CreateAnswer(options,
+                     [promise](const std::shared_ptr<RtcSessionDescription> & description) {
+                         promise->Resolve(description);
+                     },
+                     [promise](const std::string & error) {
+                         promise->Reject(error);
+                     });
+        return promise;
+    }
+    
+    PromisePtr<std::shared_ptr<const RtcSessionDescription>> RtcPeerConnection::
+    SetLocalDescription(const std::shared_ptr<const RtcSessionDescription> & description)
+    {
+        auto promise = Promise<std::shared_ptr<const RtcSessionDescription>>::Create();
+        SetLocalDescription(description,
+                            [promise, description]() {
+                                promise->Resolve(description);
+                            },
+                            [promise](const std::string & error) {
+                                promise->Reject(error);
+                            });
+        return promise;
+    }
+    
     std::shared_ptr<const RtcSessionDescription> RtcPeerConnection::
     local_description() {
         auto desc = pending_local_description();
@@ -13,6 +13,7 @@
 #include <nwr/base/env.h>
 #include <nwr/base/array.h>
 #include <nwr/base/func.h>
+#include <nwr/base/promise.h>
 #include <nwr/base/task_queue.h>
 #include <nwr/base/lib_webrtc.h>
 #include "post_target.h"
@@ -40,6 +41,14 @@ namespace nwr {
             void SetLocalDescription(const std::shared_ptr<const RtcSessionDescription> & description,
                                      const std::function<void()> & success,
                                      const std::function<void(const std::string &)> & failure);
+            //  the promise forms of the above, to chain the steps with Then
+            PromisePtr<std::shared_ptr<RtcSessionDescription>>
+            CreateOffer(const std::shared_ptr<MediaTrackConstraints> & options);
+            PromisePtr<std::shared_ptr<RtcSessionDescription>>
+            CreateAnswer(const std::shared_ptr<MediaTrackConstraints> & options);
+            //  resolved with the description set
+            PromisePtr<std::shared_ptr<const RtcSessionDescription>>
+            SetLocalDescription(const std::shared_ptr<const RtcSessionDescription> & description);
             std::shared_ptr<const RtcSessionDescription> local_description();
             std::shared_ptr<const RtcSessionDescription> current_local_description();
             std::shared_ptr<const RtcSessionDescription> pending_local_description();
@@ -32,8 +32,8 @@ namespace jsrtc {
     
     Any RtcSessionDescription::ToAny() const {
         return Any(Any::ObjectType {
-            { "type", Any(type_) },
-            { "sdp", Any(sdp_) }
+            { Atom("type"), Any(type_) },
+            { Atom("sdp"), Any(sdp_) }
         });
     }
     
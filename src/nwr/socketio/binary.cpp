@@ -30,23 +30,26 @@ namespace sio {
         
         if (data.type() == Any::Type::Data) {
             Any placeholder = Any(Any::ObjectType {
-                { "_placeholder", Any(true) },
-                { "num", Any(static_cast<int>(buffers.size())) }
+                { atoms::kPlaceholder, Any(true) },
+                { atoms::kNum, Any(static_cast<int>(buffers.size())) }
             });
             buffers.push_back(data.AsData().value());
             return placeholder;
         } else if (data.type() == Any::Type::Array) {
-            Any new_data = Any(Any::ArrayType{});
-            for (int i = 0; i < data.count(); i++) {
-                new_data.SetAt(i, _DeconstructPacket(data.GetAt(i), buffers));
+            const auto & array = *data.AsArrayPointer();
+            Any::ArrayType new_array;
+            new_array.reserve(array.size());
+            for (const auto & element : array) {
+                new_array.push_back(_DeconstructPacket(element, buffers));
             }
-            return new_data;
+            return Any(std::move(new_array));
         } else if (data.type() == Any::Type::Object) {
-            Any new_data(Any::ObjectType{});
-            for (auto key : data.keys()) {
-                new_data.SetAt(key, _DeconstructPacket(data.GetAt(key), buffers));
-            }
-            return new_data;
+            Any::ObjectType new_object;
+            new_object.reserve(data.count());
+            data.ForEach([&](const std::string & key, const Any & value) {
+                new_object[Atom(key)] = _DeconstructPacket(value, buffers);
+            });
+            return Any(std::move(new_object));
         }
         
         return data;
@@ -63,8 +66,8 @@ namespace sio {
     Any _ReconstructPacket(Any data, const std::vector<DataPtr> & buffers,
                            int & cur_place_holder)
     {
-        if (data.HasKey("_placeholder")) {
-            auto buf = buffers[data.GetAt("num").AsInt().value()]; // appropriate buffer (should be natural order anyway)
+        if (data.HasKey(atoms::kPlaceholder)) {
+            auto buf = buffers[data.GetAt(atoms::kNum).AsInt().value()]; // appropriate buffer (should be natural order anyway)
             return Any(buf);
         } else if (data.type() == Any::Type::Array) {
             for (int i = 0; i < data.count(); i++) {
@@ -89,14 +92,14 @@ namespace sio {
             return true;
         }
         if (data.type() == Any::Type::Array) {
-            for (int i = 0; i < data.count(); i++) {
-                if (_HasBinary(data.GetAt(i))) {
+            for (const auto & element : *data.AsArrayPointer()) {
+                if (_HasBinary(element)) {
                     return true;
                 }
             }
         } else if (data.type() == Any::Type::Object) {
-            for (auto key : data.keys()) {
-                if (_HasBinary(data.GetAt(key))) {
+            for (const auto & entry : *data.AsObjectPointer()) {
+                if (_HasBinary(entry.second)) {
                     return true;
                 }
             }
@@ -51,10 +51,10 @@ namespace sio {
         set_timeout(p.timeout);
         ready_state_ = ReadyState::Closed;
         uri_ = uri;
-        last_ping_ = Optional<std::chrono::system_clock::time_point>();
+        last_ping_ = Optional<TimerService::Clock::time_point>();
         encoding_ = false;
         encoder_ = std::make_shared<Encoder>();
-        decoder_ = std::make_shared<Decoder>();
+        decoder_ = std::make_shared<Decoder>(p.decode_on_worker, p.decode_to_arena);
         auto_connect_ = p.auto_connect;
         if (auto_connect_) {
             Open([](Optional<Error> e){});
@@ -135,6 +135,14 @@ namespace sio {
         }
     }
 
+    Websocket::Stats Manager::stats() {
+        auto stats = replaced_engine_stats_;
+        if (engine_) {
+            stats += engine_->stats();
+        }
+        return stats;
+    }
+    
     void Manager::Open(const std::function<void(const Optional<Error> &)> & callback) {
         printf("[%s] ready_state = %d\n", __PRETTY_FUNCTION__ ,(int)ready_state_);
         if (ready_state_ == ReadyState::Open || ready_state_ == ReadyState::Opening) {
@@ -143,6 +151,9 @@ namespace sio {
         
         printf("[%s] uri=%s\n", __PRETTY_FUNCTION__, uri_.c_str());
         
+        if (engine_) {
+            replaced_engine_stats_ += engine_->stats();
+        }
         engine_ = eio::Socket::Create(uri_, params_);
         
         auto socket = engine_;
@@ -235,12 +246,13 @@ namespace sio {
     }
     
     void Manager::OnPing() {
-        last_ping_ = Some(std::chrono::system_clock::now());
+        //  the clock of the queue, so a virtual time run measures in virtual time
+        last_ping_ = Some(TaskQueue::current_queue()->timer_service()->now());
         EmitAll("ping", {});
     }
     
     void Manager::OnPong() {
-        auto duration = std::chrono::duration_cast<TimeDuration>(std::chrono::system_clock::now() - *last_ping_);
+        auto duration = std::chrono::duration_cast<TimeDuration>(TaskQueue::current_queue()->timer_service()->now() - *last_ping_);
         EmitAll("pong", { Any(duration.count()) });
     }
     
@@ -365,15 +377,19 @@ namespace sio {
     void Manager::OnClose() {
         printf("[%s]\n", __PRETTY_FUNCTION__);
 
-        Cleanup();
-//        this.backoff.reset();
-        ready_state_ = ReadyState::Closed;
-        
-        close_emitter_->Emit(None());
-        
-        if (reconnection_ && !skip_reconnect_) {
-            Reconnect();
-        }
+        //  the packets received before the close are emitted first
+        auto thiz = shared_from_this();
+        decoder_->Flush([thiz]{
+            thiz->Cleanup();
+//            this.backoff.reset();
+            thiz->ready_state_ = ReadyState::Closed;
+            
+            thiz->close_emitter_->Emit(None());
+            
+            if (thiz->reconnection_ && !thiz->skip_reconnect_) {
+                thiz->Reconnect();
+            }
+        });
     }
 
     
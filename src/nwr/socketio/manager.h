@@ -53,6 +53,8 @@ namespace sio {
         std::map<std::string, std::shared_ptr<Socket>> nsps() { return nsps_; }
         ReadyState ready_state() { return ready_state_; }
         bool auto_connect() { return auto_connect_; }
+        //  summed over every engine this manager opened
+        Websocket::Stats stats();
     private:
         void EachNsp(const std::function<void(const std::shared_ptr<Socket> &)
                      > & proc);
@@ -123,7 +125,7 @@ namespace sio {
         ReadyState ready_state_;
         std::string uri_;
         std::vector<std::shared_ptr<Socket>> connecting_;
-        Optional<std::chrono::system_clock::time_point> last_ping_;
+        Optional<TimerService::Clock::time_point> last_ping_;
         bool encoding_;
         std::vector<Packet> packet_buffer_;
         std::shared_ptr<Encoder> encoder_;
@@ -131,6 +133,7 @@ namespace sio {
         bool auto_connect_;
         bool reconnecting_;
         std::shared_ptr<eio::Socket> engine_;
+        Websocket::Stats replaced_engine_stats_;
         bool skip_reconnect_;
 
         
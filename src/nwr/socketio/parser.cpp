@@ -59,7 +59,7 @@ namespace sio {
         // json data
         if (packet.data) {
             if (nsp) { str += ","; }
-            str += packet.data.ToJsonString();
+            JsonAppendAny(str, packet.data);
         }
         
 //        debug('encoded %j as %s', obj, str);
@@ -81,16 +81,71 @@ namespace sio {
         return buffers; // write all the buffers
     }
     
-    Decoder::Decoder():
+    Decoder::Decoder(bool decode_on_worker, bool decode_to_arena):
+    decode_on_worker_(decode_on_worker),
+    decode_to_arena_(decode_to_arena),
     decoded_emitter_(std::make_shared<Emitter<Packet>>())
     {}
     
-    Decoder::~Decoder(){}
+    Decoder::~Decoder(){
+        if (stage_) {
+            stage_->Close();
+        }
+    }
     
     void Decoder::Add(const eio::PacketData & data) {
-        if (data.text) {
+        if (!decode_on_worker_) {
+            OnDecoded(Decode(data, decode_to_arena_));
+            return;
+        }
         
-            Packet packet = DecodeString(*data.text);
+        if (!stage_) {
+            //  closed before this dies
+            stage_ = WorkerStage<Decoded>::Create([this](const Decoded & decoded) {
+                OnDecoded(decoded);
+            });
+        }
+        const bool to_arena = decode_to_arena_;
+        stage_->Run([data, to_arena]{
+            return Decode(data, to_arena);
+        });
+    }
+    
+    void Decoder::Flush(std::function<void()> callback) {
+        if (!stage_) {
+            callback();
+            return;
+        }
+        //  moved into the result, so the callback is released on this queue
+        stage_->Run([callback]() mutable {
+            Decoded decoded;
+            decoded.binary = false;
+            decoded.flushed = std::move(callback);
+            return decoded;
+        });
+    }
+    
+    Decoder::Decoded Decoder::Decode(const eio::PacketData & data, bool to_arena) {
+        Decoded decoded;
+        decoded.binary = data.binary;
+        if (!data.binary) {
+            //  the decoded tree dies with the handlers in most cases
+            AnyArena::Scope arena_scope(to_arena ? std::make_shared<AnyArena>() : nullptr);
+            decoded.packet = DecodeString(data.char_ptr(), data.size());
+        } else {
+            decoded.data = data.slice.ToDataPtr();
+        }
+        return decoded;
+    }
+    
+    void Decoder::OnDecoded(const Decoded & decoded) {
+        if (decoded.flushed) {
+            decoded.flushed();
+            return;
+        }
+        
+        if (!decoded.binary) {
+            const Packet & packet = decoded.packet;
             if (packet.type == PacketType::BinaryEvent || packet.type == PacketType::BinaryAck) { // binary packet's json
                 reconstructor_ = std::make_shared<BinaryReconstructor>(packet);
                 
@@ -107,7 +162,7 @@ namespace sio {
             if (!reconstructor_) {
                 Fatal("got binary data when not reconstructing a packet");
             } else {
-                Optional<Packet> packet = reconstructor_->TakeBinaryData(data.binary);
+                Optional<Packet> packet = reconstructor_->TakeBinaryData(decoded.data);
                 if (packet) { // received final buffer
                     reconstructor_ = nullptr;
                     decoded_emitter_->Emit(*packet);
@@ -116,14 +171,18 @@ namespace sio {
         }
     }
     
-    Packet DecodeString(const std::string & str) {        
+    Packet DecodeString(const std::string & str) {
+        return DecodeString(str.c_str(), static_cast<int>(str.length()));
+    }
+    
+    Packet DecodeString(const char * str, int length) {
         Packet p;
         int i = 0;
         
         // look up type
-        if (str.length() <= 0) { return ParserError(); }
+        if (length <= 0) { return ParserError(); }
         
-        auto packetType = PacketTypeFromString(str.substr(0, 1));
+        auto packetType = PacketTypeFromString(std::string(str, 1));
         if (!packetType) { return ParserError(); }
         
         p.type = *packetType;
@@ -133,24 +192,24 @@ namespace sio {
             std::string buf;
             while (true) {
                 i += 1;
-                if (i >= str.length()) { break; }
+                if (i >= length) { break; }
                 char c = str[i];
                 if (c == '-') { break; }
                 buf += c;
             }
             if (!IsDigit(buf) ||
-                !(i < str.length() && str[i] == '-')) {
+                !(i < length && str[i] == '-')) {
                 Fatal("Illegal attachments");
             }
             p.attachments = atoi(buf.c_str());
         }
         
         // look up namespace (if any)
-        if (i + 1 < str.length() && str[i+1] == '/') {
+        if (i + 1 < length && str[i+1] == '/') {
             p.nsp = Some(std::string());
             while (true) {
                 i += 1;
-                if (i >= str.length()) { break; }
+                if (i >= length) { break; }
                 char c = str[i];
                 if (c == ',') { break; }
                 p.nsp = Some(*p.nsp + c);
@@ -160,12 +219,12 @@ namespace sio {
         }
         
         // look up id
-        if (i + 1 < str.length()) {
+        if (i + 1 < length) {
             if (isdigit(str[i + 1])) {
                 i += 1;
                 std::string buf;
                 while (true) {
-                    if (i >= str.length()) {
+                    if (i >= length) {
                         i -= 1;
                         break; }
                     char c = str[i];
@@ -173,17 +232,21 @@ namespace sio {
                         i -= 1;
                         break; }
                     buf += c;
+                    i += 1;
                 }
                 p.id = Some(atoi(buf.c_str()));
             }
         }
         
         // look up json data
-        if (i + 1 < str.length()) {
+        if (i + 1 < length) {
             i += 1;
-            auto data = JsonParse(str.substr(i));
-            if (!data) { return ParserError(); }
-            p.data = Any::FromJson(*data);
+            if (!JsonParseAny(reinterpret_cast<const uint8_t *>(str) + i,
+                              length - i,
+                              p.data))
+            {
+                return ParserError();
+            }
         }
         
 //        debug('decoded %s as %j', str, p);
@@ -191,6 +254,10 @@ namespace sio {
     }
     
     void Decoder::Destroy() {
+        if (stage_) {
+            stage_->Close();
+            stage_ = nullptr;
+        }
         if (reconstructor_) {
             reconstructor_->FinishedReconstruction();
             reconstructor_ = nullptr;
@@ -25,6 +25,8 @@
 #include <nwr/base/array.h>
 #include <nwr/base/emitter.h>
 #include <nwr/base/any.h>
+#include <nwr/base/any_arena.h>
+#include <nwr/base/worker_pool.h>
 
 #include <nwr/engineio/parser.h>
 
@@ -46,20 +48,41 @@ namespace sio {
     
     class Decoder {
     public:
-        Decoder();
+        //  with decode_on_worker, the packets are parsed on WorkerPool::shared()
+        //  and emitted on the queue of Add in the order of Add.
+        //  with decode_to_arena, each packet is built in an AnyArena of its own
+        explicit Decoder(bool decode_on_worker = false, bool decode_to_arena = false);
         ~Decoder();
         
         EmitterPtr<Packet> decoded_emitter() { return decoded_emitter_; }
         
         void Add(const eio::PacketData & data);
+        //  calls back after the packets of the data added before are emitted
+        void Flush(std::function<void()> callback);
         void Destroy();
     private:
+        struct Decoded {
+            bool binary;
+            Packet packet;
+            DataPtr data;
+            std::function<void()> flushed;
+        };
+        
+        //  thread safe
+        static Decoded Decode(const eio::PacketData & data, bool to_arena);
+        void OnDecoded(const Decoded & decoded);
+        
+        bool decode_on_worker_;
+        bool decode_to_arena_;
+        std::shared_ptr<WorkerStage<Decoded>> stage_;
+        
         std::shared_ptr<BinaryReconstructor> reconstructor_;
         
         EmitterPtr<Packet> decoded_emitter_;
     };
     
     Packet DecodeString(const std::string & str);
+    Packet DecodeString(const char * str, int length);
     
     class BinaryReconstructor {
     public:
@@ -107,6 +107,26 @@ namespace sio0 {
         Emit(name, args);
     }
     
+    PromisePtr<Any> Socket::EmitWithAck(const std::string & name,
+                                        const std::vector<Any> & args)
+    {
+        auto promise = Promise<Any>::Create();
+        auto ack_args = args;
+        ack_args.push_back(AnyFuncMake([promise](const Any & msg) {
+            promise->Resolve(msg);
+        }));
+        Emit(name, ack_args);
+        ack_promises_[ack_packets_] = promise;
+        return promise;
+    }
+    
+    PromisePtr<Any> Socket::JsonEmitWithAck(const std::string & name,
+                                            const std::vector<Any> & args)
+    {
+        flags_["json"] = true;
+        return EmitWithAck(name, args);
+    }
+    
     void Socket::Disconnect() {
         if (name_ == "") {
             socket_->Disconnect();
@@ -114,10 +134,20 @@ namespace sio0 {
             Packet packet;
             packet.type = PacketType::Disconnect;
             SendPacket(packet);
+            RejectAcks("disconnect");
             emitter_->Emit("disconnect", {});
         }
     }
     
+    void Socket::RejectAcks(const std::string & error) {
+        auto promises = std::move(ack_promises_);
+        ack_promises_.clear();
+        for (const auto & i : promises) {
+            acks_.erase(i.first);
+            i.second->Reject(error);
+        }
+    }
+    
     void Socket::OnPacket(const Packet & packet) {
         auto thiz = shared_from_this();
         
@@ -138,6 +168,7 @@ namespace sio0 {
                 if (name_ == "") {
                     socket_->OnDisconnect(packet.reason || std::string("booted"));
                 } else {
+                    RejectAcks(packet.reason || std::string("disconnect"));
                     emitter_->Emit("disconnect",
                                    { Any(packet.reason) }
                                    );
@@ -178,6 +209,7 @@ namespace sio0 {
                         ack->Call(packet.args);
                     }
                     acks_.erase(packet.ack_id);
+                    ack_promises_.erase(packet.ack_id);
                 }
                 break;
             }
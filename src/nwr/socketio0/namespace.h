@@ -15,6 +15,7 @@
 #include <nwr/base/any.h>
 #include <nwr/base/any_emitter.h>
 #include <nwr/base/any_func.h>
+#include <nwr/base/promise.h>
 
 #include "parser.h"
 #include "socket.h"
@@ -40,8 +41,16 @@ namespace sio0 {
                   const std::vector<Any> & args);
         void JsonEmit(const std::string & name,
                       const std::vector<Any> & args);
+        //  Emit with an ack appended, settled by the first argument of the ack.
+        //  rejected when the socket disconnects or closes before the ack
+        PromisePtr<Any> EmitWithAck(const std::string & name,
+                                    const std::vector<Any> & args);
+        PromisePtr<Any> JsonEmitWithAck(const std::string & name,
+                                        const std::vector<Any> & args);
         void Disconnect();
         void OnPacket(const Packet & packet);
+        //  rejects the promises of EmitWithAck waiting for their acks
+        void RejectAcks(const std::string & error);
 
     private:
         std::shared_ptr<CoreSocket> socket_;
@@ -49,6 +58,7 @@ namespace sio0 {
         std::map<std::string, bool> flags_;
         int ack_packets_;
         std::map<int, AnyFuncPtr> acks_;
+        std::map<int, PromisePtr<Any>> ack_promises_;
         AnyEmitterPtr emitter_;
     };
 }
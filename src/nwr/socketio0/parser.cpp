@@ -35,18 +35,27 @@ namespace sio0 {
         std::string id = packet.id ? Format("%d", *packet.id) : std::string();
         std::string endpoint = packet.endpoint;
         std::string ack = packet.ack || std::string();
-        Optional<std::string> data = None();
         
+        // construct packet with required fragments
+        std::string encoded = Format("%d", type);
+        encoded += ":";
+        encoded += id;
+        if (ack == "data") { encoded += "+"; }
+        encoded += ":";
+        encoded += endpoint;
+        
+        // data fragment is optional,
+        // written in place after the separator
         switch (packet.type) {
             case PacketType::Error: {
                 int reason = packet.reason ? IndexOf(Parser::reasons_, packet.reason.value()) : -1;
                 int adv = packet.advice ? IndexOf(Parser::advice_, packet.advice.value()) : -1;
 
                 if (reason != -1 || adv != -1) {
-                    std::string data_str =
-                    Format("%d", reason) +
-                    (adv != -1 ? Format("+%d", adv) : "");
-                    data = Some(data_str);
+                    encoded += Format(":%d", reason);
+                    if (adv != -1) {
+                        encoded += Format("+%d", adv);
+                    }
                 }
 
                 break;
@@ -54,56 +63,45 @@ namespace sio0 {
             case PacketType::Message: {
                 std::string packet_data = packet.data.AsString().value();
                 if (packet_data != "") {
-                    data = Some(packet_data);
+                    encoded += ":";
+                    encoded += packet_data;
                 }
                 break;
             }
             case PacketType::Event: {
                 Any ev(Any::ObjectType {
-                    { "name", Any(packet.name) }
+                    { atoms::kName, Any(packet.name) }
                 });
                 
-                ev.SetAt("args", Any(packet.args));
+                ev.SetAt(atoms::kArgs, Any(packet.args));
                 
-                data = Some(ev.ToJsonString());
+                encoded += ":";
+                JsonAppendAny(encoded, ev);
                 
                 break;
             }
             case PacketType::Json: {
-                data = Some(packet.data.ToJsonString());
+                encoded += ":";
+                JsonAppendAny(encoded, packet.data);
                 break;
             }
             case PacketType::Connect: {
                 if (packet.qs) {
-                    data = Some(packet.qs.value());
+                    encoded += ":";
+                    encoded += packet.qs.value();
                 }
                 break;
             }
             case PacketType::Ack: {
-                std::string data_str = Format("%d", packet.ack_id);
-                
-                data_str += "+" + Any(packet.args).ToJsonString();
-
-                data = Some(data_str);
+                encoded += Format(":%d+", packet.ack_id);
+                JsonAppendAny(encoded, Any(packet.args));
                 break;
             }
             default:
                 break;
         }
         
-        // construct packet with required fragments
-        std::vector<std::string> encoded = {
-            Format("%d", type),
-            id + (ack == "data" ? "+" : ""),
-            endpoint
-        };
-        
-        // data fragment is optional
-        if (data) {
-            encoded.push_back(data.value());
-        }
-        
-        return Join(encoded, ":");
+        return encoded;
     }
     
     Packet DecodePacket(const std::string & arg_data) {
@@ -143,8 +141,8 @@ namespace sio0 {
             }
             case PacketType::Event: {
                 Any opts = Any::FromJsonString(data);
-                packet.name = opts.GetAt("name").AsString().value();
-                packet.args = opts.GetAt("args").AsArray() || std::vector<Any>();
+                packet.name = opts.GetAt(atoms::kName).AsString().value();
+                packet.args = opts.GetAt(atoms::kArgs).AsArray() || std::vector<Any>();
                 
                 break;
             }
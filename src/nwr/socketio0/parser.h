@@ -16,6 +16,8 @@
 #include <nwr/base/array.h>
 #include <nwr/base/string.h>
 #include <nwr/base/any.h>
+#include <nwr/base/any_arena.h>
+#include <nwr/base/json.h>
 
 namespace nwr {
 namespace sio0 {
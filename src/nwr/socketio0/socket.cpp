@@ -44,6 +44,9 @@ namespace sio0 {
         if (!o.max_reconnection_attempts) { o.max_reconnection_attempts = Some(10); }
         if (!o.auto_connect) { o.auto_connect = Some(true); }
         if (!o.manual_flush) { o.manual_flush = Some(false); }
+        if (!o.per_message_deflate) { o.per_message_deflate = Some(false); }
+        if (!o.decode_on_worker) { o.decode_on_worker = Some(false); }
+        if (!o.decode_to_arena) { o.decode_to_arena = Some(false); }
     
         connected_ = false;
         open_ = false;
@@ -110,6 +113,12 @@ namespace sio0 {
         }
     }
     
+    void CoreSocket::RejectAcks(const std::string & error) {
+        for (const auto & i : Keys(namespaces_)) {
+            Of(i)->RejectAcks(error);
+        }
+    }
+    
     void CoreSocket::Handshake(const std::function<void(const std::vector<std::string> &)> & fn) {
         auto thiz = shared_from_this();
         
@@ -131,21 +140,23 @@ namespace sio0 {
         auto url = Join(url_parts, "/");
         
         HttpRequest request(url, "GET", {});
-        auto op = HttpOperation::Create(request);
-        op->set_on_failure([complete_error](const std::string & error){
-            complete_error(error);
-        });
-        op->set_on_success([thiz, complete_success, complete_error](const HttpResponse & response) {
+        auto fetch = options_.fetch ? options_.fetch : HttpOperation::Fetch;
+        fetch(request)
+        ->Then([thiz, complete_success](const HttpResponse & response) {
             if (response.code == 200) {
                 complete_success(ToString(*response.data));
             } else {
                 thiz->connecting_ = false;
                 thiz->OnError(ToString(*response.data));
             }
-        });
+        })
+        ->Catch(complete_error);
     }
     
     std::shared_ptr<Transport> CoreSocket::GetTransport() {
+        if (options_.transport_factory) {
+            return options_.transport_factory(shared_from_this(), session_id_);
+        }
         auto transport_rawptr = new WebsocketTransport(shared_from_this(),
                                                        session_id_);
         auto transport = std::shared_ptr<WebsocketTransport>(transport_rawptr);
@@ -300,6 +311,9 @@ namespace sio0 {
             heartbeat_timeout_timer_->Cancel();
             heartbeat_timeout_timer_ = nullptr;
         }
+        
+        //  the acks of the closed transport never come
+        RejectAcks("close");
     }
 
     void CoreSocket::OnPacket(const Packet & packet) {
@@ -333,7 +347,13 @@ namespace sio0 {
             transport_->Close();
             transport_->ClearTimeouts();
             transport_ = nullptr;
+            //  it would close the transport just dropped
+            if (heartbeat_timeout_timer_) {
+                heartbeat_timeout_timer_->Cancel();
+                heartbeat_timeout_timer_ = nullptr;
+            }
             if (was_connected) {
+                RejectAcks(reason);
                 Publish("disconnect", { Any(reason) });
 //                if ('booted' != reason && this.options.reconnect && !this.reconnecting) {
 //                    this.reconnect();
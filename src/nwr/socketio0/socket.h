@@ -25,6 +25,7 @@
 namespace nwr {
 namespace sio0 {
     class Socket;
+    class CoreSocket;
     class Transport;
     
     struct SocketOptions {
@@ -49,6 +50,17 @@ namespace sio0 {
         // flash policy port
         Optional<bool> manual_flush;
         Optional<bool> force_new_connection;
+        //  offers permessage-deflate on the websocket transport
+        Optional<bool> per_message_deflate;
+        //  parses the received packets on WorkerPool::shared()
+        Optional<bool> decode_on_worker;
+        //  builds the received packets in an AnyArena per packet
+        Optional<bool> decode_to_arena;
+        //  replace the handshake request and the websocket transport when set,
+        //  for a scripted server in tests
+        std::function<PromisePtr<HttpResponse>(const HttpRequest & request)> fetch;
+        std::function<std::shared_ptr<Transport>(const std::shared_ptr<CoreSocket> & socket,
+                                                 const std::string & sessid)> transport_factory;
     };
     
     class CoreSocket : public std::enable_shared_from_this<CoreSocket> {
@@ -69,6 +81,7 @@ namespace sio0 {
         std::shared_ptr<Socket> Of(const std::string & name);
     private:
         void Publish(const std::string & event, const std::vector<Any> & args);
+        void RejectAcks(const std::string & error);
         void Handshake(const std::function<void(const std::vector<std::string> &)> & fn);
         std::shared_ptr<Transport> GetTransport();
         void Connect(const std::function<void()> & fn);
@@ -40,11 +40,42 @@ namespace sio0 {
         if (data != "") {
             // t0d0: we should only do decodePayload for xhr transports
             
-            Packet msg = DecodePacket(data);
+            const bool to_arena = *socket_->options().decode_to_arena;
+            if (*socket_->options().decode_on_worker) {
+                if (!decode_stage_) {
+                    std::weak_ptr<Transport> whiz = shared_from_this();
+                    decode_stage_ = WorkerStage<Optional<Packet>>::Create([whiz](const Optional<Packet> & packet) {
+                        auto thiz = whiz.lock();
+                        if (!thiz) { return; }
+                        thiz->OnDecoded(packet);
+                    });
+                }
+                decode_stage_->Run([data, to_arena]{
+                    AnyArena::Scope arena_scope(to_arena ? std::make_shared<AnyArena>() : nullptr);
+                    return Some(DecodePacket(data));
+                });
+                return;
+            }
+            
+            Packet msg;
+            {
+                AnyArena::Scope arena_scope(to_arena ? std::make_shared<AnyArena>() : nullptr);
+                msg = DecodePacket(data);
+            }
             OnPacket(msg);
         }
     }
     
+    void Transport::OnDecoded(const Optional<Packet> & packet) {
+        if (packet) {
+            OnPacket(*packet);
+        } else {
+            decode_stage_->Close();
+            decode_stage_ = nullptr;
+            OnClosed();
+        }
+    }
+    
     void Transport::OnPacket(const Packet & packet) {
         socket_->SetHeartbeatTimeout();
         
@@ -118,6 +149,17 @@ namespace sio0 {
     }
     
     void Transport::OnClose() {
+        //  after the packets still decoding
+        if (decode_stage_) {
+            decode_stage_->Run([]{
+                return Optional<Packet>();
+            });
+            return;
+        }
+        OnClosed();
+    }
+    
+    void Transport::OnClosed() {
         auto thiz = shared_from_this();
         
         /* FIXME: reopen delay causing a infinit loop
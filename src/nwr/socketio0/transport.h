@@ -11,6 +11,8 @@
 #include <memory>
 #include <nwr/base/timer.h>
 #include <nwr/base/emitter.h>
+#include <nwr/base/optional.h>
+#include <nwr/base/worker_pool.h>
 
 namespace nwr {
 namespace sio0 {
@@ -38,6 +40,9 @@ namespace sio0 {
         void OnDisconnect();
         void OnConnect();
         void ClearCloseTimeout();
+        //  a packet, or none for the close after the packets
+        void OnDecoded(const Optional<Packet> & packet);
+        void OnClosed();
     public:
         void ClearTimeouts();
     
@@ -54,6 +59,7 @@ namespace sio0 {
         bool is_open_;
         TimerPtr close_timeout_;
         TimerPtr reopen_timeout_;
+        std::shared_ptr<WorkerStage<Optional<Packet>>> decode_stage_;
     };
 }
 }
\ No newline at end of file
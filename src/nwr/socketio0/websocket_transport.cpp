@@ -32,13 +32,15 @@ namespace sio0 {
         
         auto query = MergeQuery(socket_->options().query.value(), "");
         
-        websocket_ = Websocket::Create(PrepareUrl() + query, "");
+        Websocket::Options options;
+        options.per_message_deflate = socket_->options().per_message_deflate.value();
+        websocket_ = Websocket::Create(PrepareUrl() + query, "", nullptr, options);
         websocket_->set_on_open([thiz](){
             thiz->OnOpen();
             thiz->socket()->SetBuffer(false);
         });
         websocket_->set_on_message([thiz](const Websocket::Message & message){
-            thiz->OnData(ToString(*message.data));
+            thiz->OnData(ToString(message.data));
         });
         websocket_->set_on_close([thiz](){
             thiz->OnClose();
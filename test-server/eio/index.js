@@ -4,4 +4,9 @@ var server = engine.listen(8080);
 server.on('connection', function(socket){
   socket.send('utf 8 string');
   socket.send(new Buffer([0, 1, 2, 3, 4, 5])); // binary data
+  socket.on('message', function(data){
+    if (typeof data !== 'string') {
+      socket.send(data); // echo binary for BenchWebsocketSend
+    }
+  });
 });
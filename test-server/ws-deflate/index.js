@@ -0,0 +1,8 @@
+var WebSocketServer = require('ws').Server;
+var server = new WebSocketServer({ port: 8081, perMessageDeflate: true });
+
+server.on('connection', function(socket){
+  socket.on('message', function(data, flags){
+    socket.send(data, { binary: flags.binary }); // echo for TestWebsocketDeflate
+  });
+});